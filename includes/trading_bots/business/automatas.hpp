@@ -2,11 +2,26 @@
 
 #include <trading_bots/business/data_types.hpp>
 #include <trading_bots/business/indices.hpp>
+#include <trading_bots/business/execution.hpp>
 
 #include <gcl/cx/type_name.hpp> // debug only
 
+#include <tuple>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <concepts>
+#include <stdexcept>
+
 #define fwd(...) static_cast<decltype(__VA_ARGS__) &&>(__VA_ARGS__)
 
+// Per-order/per-process traces on std::cout.
+// Define as 0 for sweeps/optimizers, where they dominate the processing time.
+#ifndef TRADING_BOTS_AUTOMATA_LOGS
+# define TRADING_BOTS_AUTOMATA_LOGS 1
+#endif
+
 namespace trading_bots {
 
     // todo : enforce values range -> data_type::rate
@@ -20,7 +35,23 @@ namespace trading_bots {
     };
 }
 namespace trading_bots::automata {
-    using amount_type = double;
+    using amount_type = trading_bots::business::data_types::amount_type;
+
+    struct bankruptcy_error : std::runtime_error {
+        bankruptcy_error()
+        : std::runtime_error{"business error : is_bankrupt"}
+        {}
+    };
+
+    struct order {
+        using side_type = execution::side_type;
+
+        side_type side;
+        double amount;              // USD
+        double price;
+        std::int64_t timestamp = 0; // seconds since epoch, set by recorders (see results::recorder)
+    };
+    using ledger_type = std::vector<order>;
 
     struct base {
 
@@ -30,10 +61,13 @@ namespace trading_bots::automata {
 
         using record_type = trading_bots::business::data_types::record;
         void update(const record_type & last_record) {
+            if (simulator)
+                simulator->match(last_record, [this](order::side_type side, amount_type value, amount_type price){
+                    fill(side, value, price);
+                });
             investement.update(last_record);
-            if (is_bankrupt()) {
-                std::runtime_error{"business error : is_bankrupt"};
-            }
+            if (is_bankrupt())
+                throw bankruptcy_error{};
         }
 
         auto total_capital() const {
@@ -49,18 +83,32 @@ namespace trading_bots::automata {
         void buy_up_to(amount_type value) {
             if (value == 0)
                 return;
-            std::cout << "\tBuy  : " << value << " / " << investement << '\n';
+            log("\tBuy  : ", value, " / ", investement, '\n');
+            if (simulator) {
+                if (value < 0.f)
+                    throw std::runtime_error{"business error : cannot BUY less than 0"};
+                simulator->submit_market(order::side_type::buy, value);
+                return;
+            }
 
             const auto amount = std::min(value, current_amount_USD);
             if (amount < 0.f)
                 throw std::runtime_error{"business error : cannot BUY less than 0"};
             current_amount_USD -= amount;
             investement.add_USDT_amount(amount);
+            if (ledger)
+                ledger->push_back(order{ order::side_type::buy, static_cast<double>(amount), static_cast<double>(investement.price()) });
         }
         void sell_up_to(amount_type value) {
             if (value == 0)
                 return;
-            std::cout << "\tSell : " << value << " / " << investement << '\n';
+            log("\tSell : ", value, " / ", investement, '\n');
+            if (simulator) {
+                if (value < 0.f)
+                    throw std::runtime_error{"business error : cannot SELL less than 0"};
+                simulator->submit_market(order::side_type::sell, value);
+                return;
+            }
 
             const auto amount = std::min(value, investement.to_USDT());
             if (amount < 0.f)
@@ -68,11 +116,76 @@ namespace trading_bots::automata {
             
             current_amount_USD += amount;
             investement.remove_USDT_amount(amount);
+            if (ledger)
+                ledger->push_back(order{ order::side_type::sell, static_cast<double>(amount), static_cast<double>(investement.price()) });
+        }
+
+        // Orders are appended to [value] (nullptr : not recorded). [value] must outlive this.
+        void record_orders_into(ledger_type * value) {
+            ledger = value;
+        }
+        // Orders are executed by [value] (see execution::simulator), against the next records (nullptr : instant fills at CloseLast, without fees).
+        // [value] must outlive this.
+        void execute_with(execution::simulator * value) {
+            simulator = value;
+        }
+
+        // Pending orders, which require an execution::simulator.
+        // As buy_up_to/sell_up_to : [value] == 0 places no order, and [value] < 0 throws.
+        void buy_limit(amount_type value, float price) {
+            pending_simulator("buy_limit", value).submit_limit(order::side_type::buy, value, price);
+        }
+        void sell_limit(amount_type value, float price) {
+            pending_simulator("sell_limit", value).submit_limit(order::side_type::sell, value, price);
+        }
+        void buy_stop(amount_type value, float price) {
+            pending_simulator("buy_stop", value).submit_stop(order::side_type::buy, value, price);
+        }
+        void sell_stop(amount_type value, float price) {
+            pending_simulator("sell_stop", value).submit_stop(order::side_type::sell, value, price);
         }
 
     protected:
+        static void log(auto && ... values) {
+            if constexpr (TRADING_BOTS_AUTOMATA_LOGS)
+                (std::cout << ... << fwd(values));
+        }
+
         amount_type current_amount_USD;
         trading_bots::business::data_types::wallet investement;
+        ledger_type * ledger = nullptr;
+        execution::simulator * simulator = nullptr;
+
+    private:
+        execution::simulator & pending_simulator(const char * what, amount_type value) {
+            if (not simulator)
+                throw std::logic_error{std::string{"automata::base::"} + what + " : requires an execution::simulator (see execute_with)"};
+            if (value < 0.f)
+                throw std::runtime_error{std::string{"business error : "} + what + " : cannot order less than 0"};
+            return *simulator;
+        }
+        // Fill of a simulated order : [value] is bounded by what is available, fees are paid from the traded amount
+        void fill(order::side_type side, amount_type value, amount_type price) {
+            const auto amount = side == order::side_type::buy
+                ? std::min(value, current_amount_USD)
+                : std::min(value, investement.to_USDT(price))
+            ;
+            const auto fee = simulator->fees.fee_for(amount);
+            if (amount <= 0 or amount <= fee) { // nothing left to trade once fees are paid
+                log("\tDropped ", side == order::side_type::buy ? "buy " : "sell", " : ", value, " (available : ", amount, ", fee : ", fee, ")\n");
+                return;
+            }
+            if (side == order::side_type::buy) {
+                current_amount_USD -= amount;
+                investement.add_USDT_amount(amount - fee, price);
+            }
+            else {
+                investement.remove_USDT_amount(amount, price);
+                current_amount_USD += amount - fee;
+            }
+            if (ledger)
+                ledger->push_back(order{ side, static_cast<double>(amount), static_cast<double>(price) });
+        }
     };
 
     template <typename T>
@@ -84,12 +197,20 @@ namespace trading_bots::automata {
     ;
     struct long_term : base {
         using components_type = std::tuple<>;
-        void process(components_type && components) {
-            static auto once_dummy = [this](){
-                buy_up_to(current_amount_USD);
-                return true;
-            }();
+
+        long_term(amount_type initial_amount)
+        : base{ initial_amount }
+        {}
+
+        void process(components_type &&) {
+            if (has_invested)
+                return;
+            buy_up_to(current_amount_USD);
+            has_invested = true;
         }
+
+    private:
+        bool has_invested = false; // per-instance : automatas can be instanciated many times, concurrently
     };
 
     template <std::size_t duration>
@@ -115,10 +236,10 @@ namespace trading_bots::automata {
                 if (not rsi_value)
                     return; // not enough records to process
                 
-                std::cout
-                    << gcl::cx::type_name_v<std::remove_cvref_t<decltype(*this)>> << '\n'
-                    << "\trsi = " << *rsi_value << '\n'
-                ;
+                log(
+                    gcl::cx::type_name_v<std::remove_cvref_t<decltype(*this)>>, '\n',
+                    "\trsi = ", *rsi_value, '\n'
+                );
 
                 if (*rsi_value < 50)
                     buy_up_to(current_amount_USD * (1 - (*rsi_value / 50)));
@@ -151,10 +272,10 @@ namespace trading_bots::automata {
                     *(trend_value) == business::indices::trend_value_type::stable // no observal trend
                 ) return;
 
-                std::cout
-                    << gcl::cx::type_name_v<std::remove_cvref_t<decltype(*this)>> << '\n'
-                    << "\trsi = " << *rsi_value << '\n'
-                ;
+                log(
+                    gcl::cx::type_name_v<std::remove_cvref_t<decltype(*this)>>, '\n',
+                    "\trsi = ", *rsi_value, '\n'
+                );
 
                 if (*trend_value == business::indices::trend_value_type::up and
                     *rsi_value < 50)
@@ -187,10 +308,10 @@ namespace trading_bots::automata {
                 if (not rsi_value)
                     return; // not enough records to process
                 
-                std::cout
-                    << gcl::cx::type_name_v<std::remove_cvref_t<decltype(*this)>> << '\n'
-                    << "\trsi = " << *rsi_value << '\n'
-                ;
+                log(
+                    gcl::cx::type_name_v<std::remove_cvref_t<decltype(*this)>>, '\n',
+                    "\trsi = ", *rsi_value, '\n'
+                );
                 if (*rsi_value < strategy.thresholds.buy)
                     buy_up_to(current_amount_USD * strategy.investment);
                 if (*rsi_value > strategy.thresholds.sell)
@@ -223,10 +344,10 @@ namespace trading_bots::automata {
                     *(trend_value) == business::indices::trend_value_type::stable // no observal trend
                 ) return;
                 
-                std::cout
-                    << gcl::cx::type_name_v<std::remove_cvref_t<decltype(*this)>> << '\n'
-                    << "\trsi = " << *rsi_value << '\n'
-                ;
+                log(
+                    gcl::cx::type_name_v<std::remove_cvref_t<decltype(*this)>>, '\n',
+                    "\trsi = ", *rsi_value, '\n'
+                );
                 if (trend_value == business::indices::trend_value_type::up and
                     *rsi_value < strategy.thresholds.buy)
                     buy_up_to(current_amount_USD * strategy.investment);
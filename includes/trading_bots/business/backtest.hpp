@@ -0,0 +1,85 @@
+#pragma once
+
+#include <trading_bots/business/automatas.hpp>
+#include <trading_bots/business/indices.hpp>
+#include <trading_bots/business/series.hpp>
+#include <trading_bots/details/tuple_view.hpp>
+
+#include <array>
+#include <span>
+#include <optional>
+#include <filesystem>
+#include <stack>
+#include <vector>
+#include <tuple>
+#include <variant>
+#include <utility>
+#include <type_traits>
+
+namespace trading_bots::backtest {
+
+    using record_type = business::data_types::record;
+    using features_type = std::tuple<
+        business::indices::last_record,
+        business::indices::rsi<>,
+        business::indices::trend<>,
+        business::indices::roc<>
+    >;
+
+    // records as extracted by io::csv::file : top is the oldest
+    inline auto to_chronological(std::stack<record_type> records) {
+        std::vector<record_type> values;
+        values.reserve(std::size(records));
+        while (not records.empty()) {
+            values.push_back(std::move(records.top()));
+            records.pop();
+        }
+        return values;
+    }
+
+    template <typename ... Ts>
+    auto make_array_of_variants(auto && ... args) {
+        using element_type = std::variant<Ts...>;
+        return std::array<element_type, sizeof...(Ts)>{
+            Ts{ args... }...
+        };
+    }
+
+    constexpr void update(details::TupleType auto & features, const record_type & value) {
+        [&]<std::size_t ... indexes>(std::index_sequence<indexes...>){
+            ((std::get<indexes>(features).update(value)), ...);
+        }(std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<decltype(features)>>>());
+    }
+
+    // Precomputes, once per dataset, the series of each feature of [features_type_arg] that supports it
+    template <details::TupleType features_type_arg = features_type>
+    auto make_series(std::span<const record_type> chronological_records, std::optional<std::filesystem::path> cache_directory = std::nullopt) {
+        auto values = business::indices::series{ chronological_records, std::move(cache_directory) };
+        [&]<typename ... Ts>(std::type_identity<std::tuple<Ts...>>){
+            ([&](){
+                if constexpr (requires { Ts::precompute(values); })
+                    Ts::precompute(values);
+            }(), ...);
+        }(std::type_identity<features_type_arg>{});
+        return values;
+    }
+    // Features then read [values] instead of computing, when they support it.
+    // [values] must outlive [features], and updates must follow the records [values] was made of.
+    constexpr void use(details::TupleType auto & features, const business::indices::series & values) {
+        std::apply([&](auto & ... feature){
+            ([&](){
+                if constexpr (requires { feature.use(values); })
+                    feature.use(values);
+            }(), ...);
+        }, features);
+    }
+
+    // dispatches to [value] a view of the features it requested
+    constexpr void process(details::TupleType auto & features, automata::automata_type auto & value) {
+        auto features_requested = [&features]<template <typename ...> typename T, typename ... Ts>(T<Ts...>){
+            // todo : better errors when some features are missing (avoid error bloat in std::tuple impl details)
+            return details::tuple_view::make_tuple_view<Ts...>(features);
+        }(typename std::remove_cvref_t<decltype(value)>::components_type{});
+        value.process(std::move(features_requested));
+    }
+}
@@ -5,8 +5,129 @@
 #include <iostream>
 #include <iomanip>
 #include <cassert>
+#include <cstdint>
+#include <compare>
+#include <concepts>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <charconv>
+#include <string_view>
+#include <optional>
+#include <limits>
+
+// Wallets and automatas amounts as fixed_point instead of double :
+// bit-reproducible results, whatever the operations order/batching.
+#ifndef TRADING_BOTS_FIXED_POINT_AMOUNTS
+# define TRADING_BOTS_FIXED_POINT_AMOUNTS 0
+#endif
+// fixed_point relies on the __int128 extension (GCC, Clang) : not available with MSVC
+#if TRADING_BOTS_FIXED_POINT_AMOUNTS and not defined(__SIZEOF_INT128__)
+# error "TRADING_BOTS_FIXED_POINT_AMOUNTS requires a compiler with __int128 support (GCC, Clang)"
+#endif
 
 namespace trading_bots::business::data_types {
+
+#if defined(__SIZEOF_INT128__)
+    // Signed decimal, as an integral quantity of 10^-decimals units.
+    // Products/quotients use a 128-bit intermediate, and truncate toward zero.
+    // Range : +/- 9.2e18 units, so +/- 9.2e10 with 8 decimals. Out-of-range results throw std::overflow_error.
+    // Note : the 128-bit products/quotients are scalar code, which compilers do not vectorize.
+    //        Vectorized wallet/automata loops require the default (double) amounts.
+    template <std::size_t decimals>
+    requires (decimals <= 18)
+    struct fixed_point {
+
+        using storage_type = std::int64_t;
+        constexpr static storage_type scale = []() {
+            storage_type value = 1;
+            for (std::size_t i = 0; i < decimals; ++i)
+                value *= 10;
+            return value;
+        }();
+
+        constexpr fixed_point() = default;
+        constexpr fixed_point(std::integral auto value)
+        : storage{ to_storage(static_cast<__int128>(value) * scale) }
+        {}
+        constexpr fixed_point(std::floating_point auto value) // rounded to nearest
+        : storage{ [value](){
+            const auto scaled_value = static_cast<long double>(value) * scale + (value < 0 ? -0.5L : 0.5L);
+            // also false for NaN
+            if (not (scaled_value > static_cast<long double>(std::numeric_limits<storage_type>::min()) and
+                     scaled_value < static_cast<long double>(std::numeric_limits<storage_type>::max())))
+                throw std::overflow_error{"data_types::fixed_point : out of range, or not a number"};
+            return static_cast<storage_type>(scaled_value);
+        }()}
+        {}
+        constexpr static fixed_point from_storage(storage_type value) {
+            fixed_point result;
+            result.storage = value;
+            return result;
+        }
+
+        constexpr explicit operator double() const {
+            return static_cast<double>(storage) / scale;
+        }
+        constexpr storage_type value() const {
+            return storage;
+        }
+
+        friend constexpr auto operator<=>(const fixed_point &, const fixed_point &) = default;
+        friend constexpr bool operator==(const fixed_point &, const fixed_point &) = default;
+
+        constexpr fixed_point operator-() const {
+            return from_storage(-storage);
+        }
+        constexpr fixed_point & operator+=(fixed_point other) {
+            storage = to_storage(static_cast<__int128>(storage) + other.storage);
+            return *this;
+        }
+        constexpr fixed_point & operator-=(fixed_point other) {
+            storage = to_storage(static_cast<__int128>(storage) - other.storage);
+            return *this;
+        }
+        constexpr fixed_point & operator*=(fixed_point other) {
+            storage = to_storage((static_cast<__int128>(storage) * other.storage) / scale);
+            return *this;
+        }
+        constexpr fixed_point & operator/=(fixed_point other) {
+            if (other.storage == 0)
+                throw std::domain_error{"data_types::fixed_point : division by zero"};
+            storage = to_storage((static_cast<__int128>(storage) * scale) / other.storage);
+            return *this;
+        }
+
+        friend constexpr fixed_point operator+(fixed_point lhs, fixed_point rhs) { return lhs += rhs; }
+        friend constexpr fixed_point operator-(fixed_point lhs, fixed_point rhs) { return lhs -= rhs; }
+        friend constexpr fixed_point operator*(fixed_point lhs, fixed_point rhs) { return lhs *= rhs; }
+        friend constexpr fixed_point operator/(fixed_point lhs, fixed_point rhs) { return lhs /= rhs; }
+
+        friend std::ostream & operator<<(std::ostream & os, const fixed_point & value) {
+            return os << static_cast<double>(value);
+        }
+
+    private:
+        constexpr static storage_type to_storage(__int128 value) {
+            if (value < std::numeric_limits<storage_type>::min() or value > std::numeric_limits<storage_type>::max())
+                throw std::overflow_error{"data_types::fixed_point : out of range"};
+            return static_cast<storage_type>(value);
+        }
+
+        storage_type storage = 0;
+    };
+    static_assert(fixed_point<2>{ 0.125 }.value() == 13);
+    static_assert(fixed_point<2>{ -0.125 }.value() == -13);
+    static_assert(fixed_point<8>{ 3 } * fixed_point<8>{ 0.5 } == fixed_point<8>{ 1.5 });
+    static_assert(fixed_point<8>{ 1 } / fixed_point<8>{ 3 } == fixed_point<8>::from_storage(33333333));
+#endif
+
+#if TRADING_BOTS_FIXED_POINT_AMOUNTS
+    using amount_type = fixed_point<8>;
+#else
+    using amount_type = double;
+#endif
+
     struct rate {
         using value_type = float;
         constexpr rate(value_type arg)
@@ -60,8 +181,37 @@ namespace trading_bots::business::data_types {
             return (High / Low) - 1;
         }
 
+        using timestamp_type = std::chrono::sys_seconds;
+        timestamp_type timestamp() const {
+            return parse_date(Date);
+        }
+        // Date : MM/DD/YYYY
+        static timestamp_type parse_date(std::string_view date) {
+            const auto parse_field = [&date](std::size_t offset, std::size_t size) {
+                int value = 0;
+                const auto field = date.substr(offset, size);
+                const auto [end, error] = std::from_chars(std::data(field), std::data(field) + std::size(field), value);
+                if (error not_eq std::errc{} or end not_eq std::data(field) + std::size(field))
+                    throw std::invalid_argument{"trades::record : corrupted datas Date"};
+                return value;
+            };
+            if (std::size(date) not_eq 10 or date[2] not_eq '/' or date[5] not_eq '/')
+                throw std::invalid_argument{"trades::record : corrupted datas Date"};
+
+            const auto value = std::chrono::year_month_day{
+                std::chrono::year{ parse_field(6, 4) },
+                std::chrono::month{ static_cast<unsigned>(parse_field(0, 2)) },
+                std::chrono::day{ static_cast<unsigned>(parse_field(3, 2)) }
+            };
+            if (not value.ok())
+                throw std::invalid_argument{"trades::record : corrupted datas Date"};
+            return std::chrono::sys_days{ value };
+        }
+
+        using volume_type = std::optional<double>; // nullopt : not available ("N/A")
+
         float       Low,  High, Open;
-        std::string Volume;
+        volume_type Volume;
         float       CloseLast;
         std::string Date;
 
@@ -89,30 +239,42 @@ namespace trading_bots::business::data_types {
 
     struct wallet {
 
-        using amount_type = double;
+        using amount_type = data_types::amount_type;
 
         void update(const record & value) {
             currency_price = value.CloseLast;
         }
+        auto to_USDT(amount_type at_price) const {
+            return currency_amount * at_price;
+        }
         auto to_USDT() const {
-            return currency_amount * currency_price;
+            return to_USDT(currency_price);
+        }
+        auto price() const {
+            return currency_price;
         }
         void remove_USDT_amount(amount_type amount) {
+            remove_USDT_amount(amount, currency_price);
+        }
+        void remove_USDT_amount(amount_type amount, amount_type at_price) {
             if (amount <= 0)
                 throw std::invalid_argument{"data_types::wallet::remove_USDT_amount"};
 
-            assert(to_USDT() >= amount);
+            assert(to_USDT(at_price) >= amount);
 
-            const auto currency_qty = amount / currency_price;
+            const auto currency_qty = amount / at_price;
             assert(currency_qty >= 0);
             // assert(currency_amount >= currency_qty);
             currency_amount -= std::min(currency_amount, currency_qty); // double precision
         }
         void add_USDT_amount(amount_type amount) {
+            add_USDT_amount(amount, currency_price);
+        }
+        void add_USDT_amount(amount_type amount, amount_type at_price) {
             if (amount <= 0)
                 throw std::invalid_argument{"data_types::wallet::add_USDT_amount"};
 
-            const auto currency_qty = amount / currency_price;
+            const auto currency_qty = amount / at_price;
             assert(currency_qty >= 0);
             currency_amount += currency_qty;
         }
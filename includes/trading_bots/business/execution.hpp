@@ -0,0 +1,182 @@
+#pragma once
+
+#include <trading_bots/business/data_types.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+// Orders execution against records' Open/High/Low/Close, instead of instant fills at CloseLast.
+// See automata::base::execute_with.
+//
+// Orders submitted while processing a record are matched against the next one :
+//  - market : at its Open, with slippage
+//  - limit  : buy  when Low  <= price, at min(Open, price)
+//             sell when High >= price, at max(Open, price)
+//  - stop   : buy  when High >= price, at max(Open, price), with slippage
+//             sell when Low  <= price, at min(Open, price), with slippage
+// Within a record, market orders are filled first, then stops, then limits.
+// Amounts are "up to", as automata::base::buy_up_to/sell_up_to : bounded by what is available when filled.
+// Limit and stop orders are pending until filled or cancelled.
+
+namespace trading_bots::automata::execution {
+
+    using amount_type = business::data_types::amount_type;
+    using record_type = business::data_types::record;
+
+    enum class side_type : std::uint8_t { buy, sell };
+
+    // fee = fixed + rate * amount, paid from the traded amount
+    struct fees {
+        double rate = 0;
+        double fixed = 0;
+
+        amount_type fee_for(amount_type amount) const {
+            return amount_type{ fixed } + amount * amount_type{ rate };
+        }
+    };
+    // adverse move of market/stop fills : price * rate + (High - Low) * amplitude_rate, bounded by [Low, High]
+    struct slippage {
+        double rate = 0;
+        double amplitude_rate = 0;
+
+        float apply(side_type side, float price, const record_type & value) const {
+            const auto offset = static_cast<float>(price * rate + (value.High - value.Low) * amplitude_rate);
+            return side == side_type::buy
+                ? std::min(price + offset, value.High)
+                : std::max(price - offset, value.Low)
+            ;
+        }
+    };
+
+    // Pending orders of one kind, as a sorted structure-of-arrays :
+    // triggered orders are always the last ones, counted by one branchless (vectorizable) pass.
+    //  is_triggered_above : triggered when price >= bound (sorted ascending), otherwise when price <= bound (descending)
+    template <bool is_triggered_above>
+    struct book {
+
+        void insert(float price, amount_type amount) {
+            const auto position = is_triggered_above
+                ? std::upper_bound(std::begin(prices), std::end(prices), price)
+                : std::upper_bound(std::begin(prices), std::end(prices), price, std::greater<>{})
+            ;
+            const auto index = std::distance(std::begin(prices), position);
+            prices.insert(position, price);
+            amounts.insert(std::next(std::begin(amounts), index), amount);
+        }
+        std::size_t triggered_quantity(float bound) const {
+            std::size_t quantity = 0;
+            for (const auto price : prices)
+                quantity += is_triggered_above ? (price >= bound) : (price <= bound);
+            return quantity;
+        }
+        // on_triggered : void(float price, amount_type amount), most aggressive first
+        void pop_triggered(float bound, auto && on_triggered) {
+            const auto quantity = triggered_quantity(bound);
+            for (std::size_t index = std::size(prices); index not_eq std::size(prices) - quantity; --index)
+                on_triggered(prices[index - 1], amounts[index - 1]);
+            prices.resize(std::size(prices) - quantity);
+            amounts.resize(std::size(amounts) - quantity);
+        }
+        std::size_t size() const {
+            return std::size(prices);
+        }
+        void clear() {
+            prices.clear();
+            amounts.clear();
+        }
+
+    private:
+        std::vector<float> prices;
+        std::vector<amount_type> amounts;
+    };
+
+    // Pending orders of one automata, and its execution models
+    struct simulator {
+
+        simulator(execution::fees fees_value = {}, execution::slippage slippage_value = {})
+        : fees{ fees_value }
+        , slippage{ slippage_value }
+        {}
+
+        void submit_market(side_type side, amount_type amount) {
+            if (amount < 0)
+                throw std::invalid_argument{"execution::simulator::submit_market : amount < 0"};
+            if (amount == 0)
+                return;
+            market_orders.push_back({ side, amount });
+        }
+        void submit_limit(side_type side, amount_type amount, float price) {
+            if (amount < 0)
+                throw std::invalid_argument{"execution::simulator::submit_limit : amount < 0"};
+            if (amount == 0)
+                return;
+            if (price <= 0)
+                throw std::invalid_argument{"execution::simulator::submit_limit : price <= 0"};
+            side == side_type::buy
+                ? buy_limits.insert(price, amount)
+                : sell_limits.insert(price, amount)
+            ;
+        }
+        void submit_stop(side_type side, amount_type amount, float price) {
+            if (amount < 0)
+                throw std::invalid_argument{"execution::simulator::submit_stop : amount < 0"};
+            if (amount == 0)
+                return;
+            if (price <= 0)
+                throw std::invalid_argument{"execution::simulator::submit_stop : price <= 0"};
+            side == side_type::buy
+                ? buy_stops.insert(price, amount)
+                : sell_stops.insert(price, amount)
+            ;
+        }
+        void cancel_all() {
+            market_orders.clear();
+            buy_limits.clear();
+            sell_limits.clear();
+            buy_stops.clear();
+            sell_stops.clear();
+        }
+        std::size_t pending_quantity() const {
+            return std::size(market_orders) + buy_limits.size() + sell_limits.size() + buy_stops.size() + sell_stops.size();
+        }
+
+        // Fills the orders [value] triggers.
+        // on_fill : void(side_type, amount_type amount_up_to, amount_type price)
+        void match(const record_type & value, auto && on_fill) {
+
+            for (const auto & order : market_orders)
+                on_fill(order.side, order.amount, amount_type{ slippage.apply(order.side, value.Open, value) });
+            market_orders.clear();
+
+            buy_stops.pop_triggered(value.High, [&](float price, amount_type amount){
+                on_fill(side_type::buy, amount, amount_type{ slippage.apply(side_type::buy, std::max(value.Open, price), value) });
+            });
+            sell_stops.pop_triggered(value.Low, [&](float price, amount_type amount){
+                on_fill(side_type::sell, amount, amount_type{ slippage.apply(side_type::sell, std::min(value.Open, price), value) });
+            });
+            buy_limits.pop_triggered(value.Low, [&](float price, amount_type amount){
+                on_fill(side_type::buy, amount, amount_type{ std::min(value.Open, price) });
+            });
+            sell_limits.pop_triggered(value.High, [&](float price, amount_type amount){
+                on_fill(side_type::sell, amount, amount_type{ std::max(value.Open, price) });
+            });
+        }
+
+        const execution::fees fees;
+        const execution::slippage slippage;
+
+    private:
+        struct market_order {
+            side_type side;
+            amount_type amount;
+        };
+        std::vector<market_order> market_orders;
+        book<true>  buy_limits;     // triggered when Low  <= price
+        book<false> sell_limits;    // triggered when High >= price
+        book<false> buy_stops;      // triggered when High >= price
+        book<true>  sell_stops;     // triggered when Low  <= price
+    };
+}
@@ -1,8 +1,16 @@
 #pragma once
 
 #include <trading_bots/business/data_types.hpp>
+#include <trading_bots/business/series.hpp>
 
 #include <stack>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <memory_resource>
+#include <array>
+#include <stdexcept>
 #include <optional>
 #include <numeric>
 #include <cmath>
@@ -21,6 +29,40 @@ namespace trading_bots::business::indices {
         up, stable, down
     };
 
+    // Precomputed values of an index, at the position of the latest update.
+    template <series::kind index, std::size_t max_duration>
+    struct precomputed_view {
+
+        void bind(const series & values) {
+            source = &values;
+            position = 0;
+            for (std::size_t duration = 0; duration <= max_duration; ++duration)
+                columns[duration] = values.column(index, max_duration, duration);
+        }
+        explicit operator bool() const {
+            return source not_eq nullptr;
+        }
+        void update(const record_type & input) {
+            assert(position < source->size());
+            assert(source->prices()[position] == input.CloseLast); // updates must follow the series records
+            ++position;
+        }
+        std::size_t records_quantity() const {
+            return position;
+        }
+        float latest(std::size_t duration) const {
+            assert(position not_eq 0 and duration <= max_duration);
+            if (columns[duration] == nullptr)
+                throw std::out_of_range{"indices::precomputed_view : missing series, see indices::series::compute_*"};
+            return (*columns[duration])[position - 1];
+        }
+
+    private:
+        const series * source = nullptr;
+        std::size_t position = 0;
+        std::array<const series::column_type *, max_duration + 1> columns{};
+    };
+
     struct last_record {
         void update(const record_type & input) {
             value = input;
@@ -32,8 +74,24 @@ namespace trading_bots::business::indices {
     requires (max_duration not_eq 0)
     struct rsi {
 
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        rsi() = default;
+        explicit rsi(const allocator_type & allocator)
+        : cache{ allocator }
+        {}
+
+        // Reads [values] instead of computing. [values] must outlive this, and updates must follow its records.
+        void use(const series & values) {
+            precomputed.bind(values);
+        }
+        static void precompute(series & values) {
+            values.compute_rsi(max_duration);
+        }
+
         void update(const record_type & input) {
-            cache.push_front(input);
+            if (precomputed)
+                return precomputed.update(input);
+            cache.push_front(input.CloseLast);
             if (cache.size() > max_duration)
                 cache.pop_back();
             assert(cache.size() <= max_duration);
@@ -45,8 +103,10 @@ namespace trading_bots::business::indices {
             if (duration <= 1)
                 throw std::invalid_argument{"rsi::value_for_duration : duration <= 1"};
 
-            if (std::size(cache) < duration)
+            if (cached_quantity() < duration)
                 return std::nullopt;
+            if (precomputed)
+                return precomputed.latest(duration);
 
             auto range_begin = std::next(std::crbegin(cache));
             auto range_end = std::next(std::crbegin(cache), duration);
@@ -56,8 +116,8 @@ namespace trading_bots::business::indices {
                 range_begin,
                 range_end,
                 0.0,
-                [prev_element_it = std::crbegin(cache)](amount_type result, const record_type & element) mutable {
-                    const amount_type variation = ((element.CloseLast / prev_element_it->CloseLast) * 100.0) - 100;
+                [prev_element_it = std::crbegin(cache)](amount_type result, const float element) mutable {
+                    const amount_type variation = ((element / *prev_element_it) * 100.0) - 100;
                     ++prev_element_it;
                     if (variation > .0) // is gain
                         return result += variation;
@@ -68,8 +128,8 @@ namespace trading_bots::business::indices {
                 range_begin,
                 range_end,
                 0.0,
-                [prev_element_it = std::crbegin(cache)](amount_type result, const record_type & element) mutable {
-                    const amount_type variation = ((element.CloseLast / prev_element_it->CloseLast) * 100.0) - 100;
+                [prev_element_it = std::crbegin(cache)](amount_type result, const float element) mutable {
+                    const amount_type variation = ((element / *prev_element_it) * 100.0) - 100;
                     ++prev_element_it;
                     if (variation < .0) // is loss
                         return result += std::fabs(variation);
@@ -85,42 +145,79 @@ namespace trading_bots::business::indices {
         }
 
     private:
-        std::deque<record_type> cache;
+        std::size_t cached_quantity() const {
+            return precomputed
+                ? std::min(precomputed.records_quantity(), max_duration)
+                : std::size(cache)
+            ;
+        }
+
+        std::pmr::deque<float> cache; // closes, latest first
+        precomputed_view<series::kind::rsi, max_duration> precomputed;
     };
 
     template <std::size_t max_duration = 14>
     requires (max_duration > 1)
     struct trend { 
         using value_type = trend_value_type;  
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        trend() = default;
+        explicit trend(const allocator_type & allocator)
+        : cache{ allocator }
+        {}
+
+        static void precompute(series & values) {
+            values.compute_trend(max_duration);
+        }
         
         std::optional<value_type> value_for_duration(std::size_t duration, float fluctuation_threshold) const {
 
             if (duration <= 1)
                 throw std::invalid_argument{"trend::value_for_duration : duration <= 1"};
 
-            if (std::size(cache) < duration)
+            if (cached_quantity() <= duration) // past_input is the (duration)th record before the latest one
                 return std::nullopt;
 
-            const auto latest_input = std::begin(cache);
-            const auto past_input = std::next(latest_input, duration);
+            const auto fluctuation_rate = [&](){
+                if (precomputed)
+                    return precomputed.latest(duration);
 
-            const auto fluctuation_rate = (latest_input->CloseLast / past_input->CloseLast) - 1;
+                const auto latest_input = std::begin(cache);
+                const auto past_input = std::next(latest_input, duration);
+                return (*latest_input / *past_input) - 1;
+            }();
             if (fluctuation_rate < fluctuation_threshold and fluctuation_rate > -fluctuation_threshold)
                 return value_type::stable;
             else
                 return fluctuation_rate < .0 ? value_type::down : value_type::up;
         }
 
+        // Reads [values] instead of computing. [values] must outlive this, and updates must follow its records.
+        void use(const series & values) {
+            precomputed.bind(values);
+        }
+
         void update(const record_type & input) {
 
-            cache.push_front(input);
-            if (cache.size() > max_duration)
+            if (precomputed)
+                return precomputed.update(input);
+            cache.push_front(input.CloseLast);
+            if (cache.size() > max_duration + 1)
                 cache.pop_back();
-            assert(cache.size() <= max_duration);
+            assert(cache.size() <= max_duration + 1);
         }
 
     private:
-        std::deque<record_type> cache;
+        std::size_t cached_quantity() const {
+            return precomputed
+                ? std::min(precomputed.records_quantity(), max_duration + 1)
+                : std::size(cache)
+            ;
+        }
+
+        std::pmr::deque<float> cache; // closes, latest first
+        precomputed_view<series::kind::trend, max_duration> precomputed;
     };
     
     // todo : MA / EMA / BOLL
@@ -132,21 +229,34 @@ namespace trading_bots::business::indices {
     requires (max_duration > 1)
     struct roc { 
         using value_type = float;
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        roc() = default;
+        explicit roc(const allocator_type & allocator)
+        : cache{ allocator }
+        {}
+
+        static void precompute(series & values) {
+            values.compute_roc(max_duration);
+        }
+
         std::optional<value_type> value_for_duration(std::size_t duration) const {
 
             if (duration <= 1)
                 throw std::invalid_argument{"roc::value_for_duration : duration <= 1"};
 
-            if (std::size(cache) < duration)
+            if (cached_quantity() <= duration) // past_input is the (duration)th record before the latest one
                 return std::nullopt;
+            if (precomputed)
+                return precomputed.latest(duration);
 
             const auto latest_input = std::begin(cache);
             const auto past_input = std::next(latest_input, duration);
 
             return (
                 (
-                    (latest_input->CloseLast - past_input->CloseLast)
-                    / past_input->CloseLast
+                    (*latest_input - *past_input)
+                    / *past_input
                 ) * 100
             );
 
@@ -154,15 +264,403 @@ namespace trading_bots::business::indices {
             // https://www.investopedia.com/terms/p/pricerateofchange.asp
         }
 
+        // Reads [values] instead of computing. [values] must outlive this, and updates must follow its records.
+        void use(const series & values) {
+            precomputed.bind(values);
+        }
+
         void update(const record_type & input) {
 
-            cache.push_front(input);
-            if (cache.size() > max_duration)
+            if (precomputed)
+                return precomputed.update(input);
+            cache.push_front(input.CloseLast);
+            if (cache.size() > max_duration + 1)
                 cache.pop_back();
-            assert(cache.size() <= max_duration);
+            assert(cache.size() <= max_duration + 1);
+        }
+
+    private:
+        std::size_t cached_quantity() const {
+            return precomputed
+                ? std::min(precomputed.records_quantity(), max_duration + 1)
+                : std::size(cache)
+            ;
+        }
+
+        std::pmr::deque<float> cache; // closes, latest first
+        precomputed_view<series::kind::roc, max_duration> precomputed;
+    };
+
+    // Rolling minimum (or maximum, with std::greater<>) of the latest [max_duration] values.
+    // Monotonic queue : update in amortized O(1), value over the latest [duration] values in O(log max_duration).
+    template <std::size_t max_duration, typename compare_type = std::less<>>
+    requires (max_duration not_eq 0)
+    struct rolling_extremum {
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        rolling_extremum() = default;
+        explicit rolling_extremum(const allocator_type & allocator)
+        : candidates{ allocator }
+        {}
+
+        void update(float value) {
+            // candidates which can no longer be the extremum of any window
+            while (not candidates.empty() and not compare_type{}(candidates.back().value, value))
+                candidates.pop_back();
+            candidates.push_back({ position, value });
+            ++position;
+            if (candidates.front().position + max_duration < position) // out of the largest window
+                candidates.pop_front();
+        }
+
+        std::size_t records_quantity() const {
+            return position;
+        }
+        std::optional<float> value_for_duration(std::size_t duration) const {
+            if (duration == 0 or duration > max_duration)
+                throw std::invalid_argument{"rolling_extremum::value_for_duration : duration not in [1, max_duration]"};
+            if (position < duration)
+                return std::nullopt;
+            // positions increase, so the first candidate in the window is its extremum :
+            // the front for max_duration (and any window the front is in), otherwise a binary search
+            const auto window_begin = position - duration;
+            if (candidates.front().position >= window_begin)
+                return candidates.front().value;
+            const auto it = std::partition_point(std::cbegin(candidates), std::cend(candidates), [&](const auto & candidate){
+                return candidate.position < window_begin;
+            });
+            return it->value;
+        }
+
+    private:
+        struct candidate_type {
+            std::size_t position;
+            float value;
+        };
+        std::pmr::deque<candidate_type> candidates; // values ordered by compare_type, oldest first
+        std::size_t position = 0;
+    };
+
+    // Donchian channel : lowest Low and highest High
+    template <std::size_t max_duration = 14>
+    requires (max_duration not_eq 0)
+    struct donchian {
+
+        struct value_type {
+            float lowest_low;
+            float highest_high;
+        };
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        donchian() = default;
+        explicit donchian(const allocator_type & allocator)
+        : lows{ allocator }
+        , highs{ allocator }
+        {}
+
+        void update(const record_type & input) {
+            lows.update(input.Low);
+            highs.update(input.High);
+        }
+
+        std::optional<value_type> value_for_duration(std::size_t duration) const {
+            const auto lowest_low = lows.value_for_duration(duration);
+            const auto highest_high = highs.value_for_duration(duration);
+            if (not lowest_low or not highest_high)
+                return std::nullopt;
+            return value_type{ *lowest_low, *highest_high };
+        }
+
+    private:
+        rolling_extremum<max_duration, std::less<>> lows;
+        rolling_extremum<max_duration, std::greater<>> highs;
+    };
+
+    // Stochastic oscillator %K : position of the latest close in the Donchian channel, as [0, 100]
+    //  Near 100 => close near the highest high (overbought)
+    //  Near   0 => close near the lowest low   (oversold)
+    template <std::size_t max_duration = 14>
+    requires (max_duration not_eq 0)
+    struct stochastic {
+
+        using value_type = float;
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        stochastic() = default;
+        explicit stochastic(const allocator_type & allocator)
+        : channel{ allocator }
+        {}
+
+        void update(const record_type & input) {
+            channel.update(input);
+            latest_close = input.CloseLast;
+        }
+
+        std::optional<value_type> value_for_duration(std::size_t duration) const {
+            const auto range = channel.value_for_duration(duration);
+            if (not range)
+                return std::nullopt;
+            const auto amplitude = range->highest_high - range->lowest_low;
+            if (amplitude == 0)
+                return value_type{ 50 }; // flat channel
+            return ((latest_close - range->lowest_low) / amplitude) * 100;
+        }
+
+    private:
+        donchian<max_duration> channel;
+        float latest_close = 0;
+    };
+
+    // Rolling percentiles of the latest [duration] closes, for any duration in [1, max_duration].
+    // Order statistics over a sorted array of the latest [max_duration] closes (not a tree) :
+    //  - update : O(log max_duration) search, then an O(max_duration) shift of contiguous floats
+    //    (for indicators windows, cheaper in practice than a balanced tree's allocations and pointer chasing)
+    //  - max_duration : percentile in O(1), rank in O(log max_duration)
+    //  - shorter durations : O(duration) per query, selecting over a stack copy of their window
+    // Queries do not modify the index : concurrent reads are safe.
+    template <std::size_t max_duration = 14>
+    requires (max_duration not_eq 0)
+    struct percentile {
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        percentile() = default;
+        explicit percentile(const allocator_type & allocator)
+        : chronological{ allocator }
+        , sorted{ allocator }
+        {}
+
+        void update(const record_type & input) {
+            const auto value = input.CloseLast;
+            if (std::size(chronological) == max_duration) {
+                const auto oldest = chronological.front();
+                chronological.pop_front();
+                sorted.erase(std::lower_bound(std::begin(sorted), std::end(sorted), oldest));
+            }
+            chronological.push_back(value);
+            sorted.insert(std::upper_bound(std::begin(sorted), std::end(sorted), value), value);
+        }
+
+        // close below which [rate] % of the latest [duration] closes are (nearest rank)
+        std::optional<float> value_for_duration(std::size_t duration, float rate) const {
+            if (duration == 0 or duration > max_duration)
+                throw std::invalid_argument{"percentile::value_for_duration : duration not in [1, max_duration]"};
+            if (rate < 0.f or rate > 100.f)
+                throw std::invalid_argument{"percentile::value_for_duration : rate must be [0.0, 100.0]"};
+            if (std::size(chronological) < duration)
+                return std::nullopt;
+            const auto index = std::max(static_cast<std::size_t>(std::ceil((rate / 100) * duration)), std::size_t{ 1 }) - 1;
+            if (duration == max_duration)
+                return sorted[index];
+            std::array<float, max_duration> window;
+            const auto window_end = std::copy(std::prev(std::cend(chronological), static_cast<std::ptrdiff_t>(duration)), std::cend(chronological), std::begin(window));
+            std::nth_element(std::begin(window), std::next(std::begin(window), static_cast<std::ptrdiff_t>(index)), window_end);
+            return window[index];
+        }
+        // percentage of the latest [duration] closes lower than the latest one
+        std::optional<float> rank_of_latest_for_duration(std::size_t duration) const {
+            if (duration == 0 or duration > max_duration)
+                throw std::invalid_argument{"percentile::rank_of_latest_for_duration : duration not in [1, max_duration]"};
+            if (std::size(chronological) < duration)
+                return std::nullopt;
+            const auto latest = chronological.back();
+            const auto below = duration == max_duration
+                ? static_cast<std::size_t>(std::distance(std::cbegin(sorted), std::lower_bound(std::cbegin(sorted), std::cend(sorted), latest)))
+                : static_cast<std::size_t>(std::count_if(std::prev(std::cend(chronological), static_cast<std::ptrdiff_t>(duration)), std::cend(chronological), [latest](float value){
+                    return value < latest;
+                }))
+            ;
+            return (static_cast<float>(below) / duration) * 100;
+        }
+
+    private:
+        std::pmr::deque<float> chronological;
+        std::pmr::vector<float> sorted;
+    };
+
+    // --- volume-based indices
+
+    // Records which Volume is not available :
+    //  - skip          : are ignored by the index, as if absent
+    //  - carry_forward : use the latest available Volume (ignored until one is)
+    enum class missing_volume_policy {
+        skip,
+        carry_forward
+    };
+
+    // Volume of [input] according to [policy], or nullopt if [input] must be ignored
+    template <missing_volume_policy policy>
+    struct volume_source {
+        std::optional<double> volume_of(const record_type & input) {
+            if constexpr (policy == missing_volume_policy::carry_forward) {
+                if (input.Volume)
+                    latest = input.Volume;
+                return latest;
+            }
+            else return input.Volume;
+        }
+    private:
+        std::optional<double> latest;
+    };
+
+    // Sums over the latest [duration] values, for any duration in [1, max_duration], in O(1) :
+    // differences of prefix sums, as doubles.
+    // Prefixes are rebased every max_duration updates (amortized O(1)), so they never grow beyond ~2 windows :
+    // the rounding error stays relative to the window sums, not to the whole history.
+    template <std::size_t max_duration>
+    requires (max_duration not_eq 0)
+    struct rolling_sum {
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        rolling_sum() = default;
+        explicit rolling_sum(const allocator_type & allocator)
+        : prefixes{ allocator }
+        {}
+
+        void update(double value) {
+            if (prefixes.empty())
+                prefixes.push_back(0.0);
+            prefixes.push_back(prefixes.back() + value);
+            if (std::size(prefixes) > max_duration + 1)
+                prefixes.pop_front();
+            if (++updates_since_rebase == max_duration) {
+                const auto base = prefixes.front();
+                for (auto & prefix : prefixes)
+                    prefix -= base;
+                updates_since_rebase = 0;
+            }
+        }
+        std::size_t available_quantity() const {
+            return prefixes.empty() ? 0 : std::size(prefixes) - 1;
+        }
+        // nullopt if less than [duration] values
+        std::optional<double> value_for_duration(std::size_t duration) const {
+            if (duration == 0 or duration > max_duration)
+                throw std::invalid_argument{"rolling_sum::value_for_duration : duration not in [1, max_duration]"};
+            if (available_quantity() < duration)
+                return std::nullopt;
+            return prefixes.back() - *std::prev(std::cend(prefixes), duration + 1);
+        }
+
+    private:
+        std::pmr::deque<double> prefixes; // oldest first
+        std::size_t updates_since_rebase = 0;
+    };
+
+    // Typical price : (High + Low + Close) / 3
+    constexpr double typical_price(const record_type & input) {
+        return (static_cast<double>(input.High) + input.Low + input.CloseLast) / 3;
+    }
+
+    // VWAP : average of typical prices, weighted by volumes
+    template <std::size_t max_duration = 14, missing_volume_policy policy = missing_volume_policy::skip>
+    requires (max_duration not_eq 0)
+    struct vwap {
+
+        using value_type = double;
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        vwap() = default;
+        explicit vwap(const allocator_type & allocator)
+        : prices_volumes{ allocator }
+        , volumes{ allocator }
+        {}
+
+        void update(const record_type & input) {
+            const auto volume = volumes_source.volume_of(input);
+            if (not volume)
+                return;
+            prices_volumes.update(typical_price(input) * *volume);
+            volumes.update(*volume);
+        }
+
+        // nullopt until [duration] records with a volume, or if their volumes are all 0
+        std::optional<value_type> value_for_duration(std::size_t duration) const {
+            const auto volume = volumes.value_for_duration(duration);
+            if (not volume or *volume == 0)
+                return std::nullopt;
+            return *prices_volumes.value_for_duration(duration) / *volume;
+        }
+
+    private:
+        volume_source<policy> volumes_source;
+        rolling_sum<max_duration> prices_volumes;
+        rolling_sum<max_duration> volumes;
+    };
+
+    // OBV => On-Balance Volume : cumulated volumes, added when the close rises, subtracted when it falls
+    template <missing_volume_policy policy = missing_volume_policy::skip>
+    struct obv {
+
+        using value_type = double;
+
+        void update(const record_type & input) {
+            const auto volume = volumes_source.volume_of(input);
+            if (not volume)
+                return;
+            if (previous_close) {
+                const auto variation = (input.CloseLast > *previous_close) - (input.CloseLast < *previous_close);
+                value += variation * *volume;
+                is_ready = true;
+            }
+            previous_close = input.CloseLast;
+        }
+
+        // nullopt until 2 records with a volume
+        std::optional<value_type> latest() const {
+            return is_ready ? std::optional{ value } : std::nullopt;
+        }
+
+    private:
+        volume_source<policy> volumes_source;
+        std::optional<float> previous_close;
+        value_type value = 0;
+        bool is_ready = false;
+    };
+
+    // MFI => Money Flow Index : RSI of money flows (typical price * volume), as [0, 100]
+    //  Near 100 => buying  pressure (overbought)
+    //  Near   0 => selling pressure (oversold)
+    template <std::size_t max_duration = 14, missing_volume_policy policy = missing_volume_policy::skip>
+    requires (max_duration not_eq 0)
+    struct mfi {
+
+        using value_type = double;
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        mfi() = default;
+        explicit mfi(const allocator_type & allocator)
+        : positive_flows{ allocator }
+        , negative_flows{ allocator }
+        {}
+
+        void update(const record_type & input) {
+            const auto volume = volumes_source.volume_of(input);
+            if (not volume)
+                return;
+            const auto price = typical_price(input);
+            if (previous_price) {
+                const auto flow = price * *volume;
+                positive_flows.update(price > *previous_price ? flow : 0.0);
+                negative_flows.update(price < *previous_price ? flow : 0.0);
+            }
+            previous_price = price;
+        }
+
+        // nullopt until [duration] flows (so, duration + 1 records with a volume)
+        std::optional<value_type> value_for_duration(std::size_t duration) const {
+            const auto positive = positive_flows.value_for_duration(duration);
+            if (not positive)
+                return std::nullopt;
+            const auto negative = *negative_flows.value_for_duration(duration);
+            if (negative == 0)
+                return *positive == 0 ? 50.0 : 100.0;
+            return 100.0 - (100.0 / (1.0 + (*positive / negative)));
         }
 
     private:
-        std::deque<record_type> cache;
+        volume_source<policy> volumes_source;
+        std::optional<double> previous_price;
+        rolling_sum<max_duration> positive_flows;
+        rolling_sum<max_duration> negative_flows;
     };
 }
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <trading_bots/business/automatas.hpp>
+#include <trading_bots/business/backtest.hpp>
+#include <trading_bots/details/memory.hpp>
+
+#include <gcl/cx/type_name.hpp>
+
+#include <array>
+#include <vector>
+#include <variant>
+#include <random>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+// Robustness of strategies over resampled histories :
+//  each path is a (moving) block bootstrap of the close-to-close returns of a given history,
+//  each bar keeping its Open/High/Low shape relative to its close.
+//
+// Note : as paths run concurrently, automatas logs should be disabled (TRADING_BOTS_AUTOMATA_LOGS=0)
+
+namespace trading_bots::monte_carlo {
+
+    using record_type = backtest::record_type;
+
+    // Per-worker counters, to check the arenas effect on the global allocator :
+    // once warm, an arena makes no upstream allocation per path, so upstream_allocations does not grow with paths
+    struct workers_report {
+        std::vector<std::size_t> paths;                 // paths processed
+        std::vector<std::size_t> upstream_allocations;  // global allocator calls of the arena (see details::memory::arena)
+        std::vector<std::size_t> arena_growths;
+    };
+
+    struct settings {
+        std::size_t paths = 1000;
+        std::size_t block_size = 7;     // consecutive records per resampled block
+        std::size_t path_length = 0;    // records per path. 0 : same as the history
+        std::uint64_t seed = 0;
+        std::size_t threads = std::thread::hardware_concurrency();
+        workers_report * report = nullptr;  // filled if not nullptr
+
+        void ensure_datas_integrity() const {
+            if (paths == 0)
+                throw std::invalid_argument{"monte_carlo::settings : paths == 0"};
+            if (block_size == 0)
+                throw std::invalid_argument{"monte_carlo::settings : block_size == 0"};
+        }
+    };
+
+    struct distribution {
+
+        std::vector<double> values; // sorted
+
+        double mean() const {
+            if (values.empty())
+                throw std::logic_error{"monte_carlo::distribution::mean : empty"};
+            return std::accumulate(std::cbegin(values), std::cend(values), 0.0) / std::size(values);
+        }
+        // value below which [rate] % of the values are : rate in [0.0, 100.0], nearest rank (as indices::percentile)
+        double percentile(double rate) const {
+            if (values.empty())
+                throw std::logic_error{"monte_carlo::distribution::percentile : empty"};
+            if (rate < 0.0 or rate > 100.0)
+                throw std::invalid_argument{"monte_carlo::distribution::percentile : rate must be [0.0, 100.0]"};
+            const auto rank = static_cast<std::size_t>(std::ceil((rate / 100) * std::size(values)));
+            return values[std::max(rank, std::size_t{ 1 }) - 1];
+        }
+    };
+
+    struct automata_result {
+        std::string_view name;
+        distribution total_capital;
+        distribution max_drawdown; // rate [0.0, 1.0] of the highest capital reached
+    };
+
+    // Resamples a path of [path.size()] records from [history] into [path], reusing its storage.
+    // Deterministic for a given rng state.
+    void resample(const std::vector<record_type> & history, std::vector<record_type> & path, std::size_t block_size, auto & rng) {
+
+        if (std::size(history) < 2)
+            throw std::invalid_argument{"monte_carlo::resample : not enough records"};
+        block_size = std::min(block_size, std::size(history) - 1);
+
+        // returns are defined for records [1, size)
+        auto block_begin = std::uniform_int_distribution<std::size_t>{ 1, std::size(history) - block_size };
+        auto close = static_cast<double>(history.front().CloseLast);
+
+        for (std::size_t index = 0; index < std::size(path);) {
+            const auto block_origin = block_begin(rng);
+            for (std::size_t offset = 0; offset < block_size and index < std::size(path); ++offset, ++index) {
+                const auto & source = history[block_origin + offset];
+                const auto & previous = history[block_origin + offset - 1];
+                const auto source_close = static_cast<double>(source.CloseLast);
+
+                close *= source_close / previous.CloseLast;
+
+                auto & value = path[index];
+                value = source; // Date is a short string : no allocation once path is warm
+                value.CloseLast = static_cast<float>(close);
+                value.Open = static_cast<float>(close * (source.Open / source_close));
+                value.High = static_cast<float>(close * (source.High / source_close));
+                value.Low = static_cast<float>(close * (source.Low / source_close));
+            }
+        }
+    }
+
+    // Runs each automata over [settings.paths] resampled paths of [records], concurrently.
+    // Each path has its own rng stream (seed, path index), automatas and features :
+    //  results do not depend on the threads quantity nor on scheduling.
+    // Memory : one path and one arena per thread, plus one capital/drawdown sample per (automata, path).
+    template <automata::automata_type ... automatas_types>
+    auto run(std::stack<record_type> records, const float initial_amount, settings arg = {}) {
+
+        arg.ensure_datas_integrity();
+        const auto history = backtest::to_chronological(std::move(records));
+        const auto path_length = arg.path_length == 0 ? std::size(history) : arg.path_length;
+
+        constexpr auto automatas_quantity = sizeof...(automatas_types);
+        // samples[automata_index][path_index]
+        std::array<std::vector<double>, automatas_quantity> capital_samples;
+        std::array<std::vector<double>, automatas_quantity> drawdown_samples;
+        for (auto & samples : capital_samples)
+            samples.resize(arg.paths);
+        for (auto & samples : drawdown_samples)
+            samples.resize(arg.paths);
+
+        const auto run_path = [&](std::size_t path_index, std::vector<record_type> & path, details::memory::arena & arena) {
+
+            auto rng = [&](){
+                // seed_seq keeps 32 bits per value : 64-bit values are split
+                const auto path_value = static_cast<std::uint64_t>(path_index);
+                auto seeds = std::seed_seq{
+                    static_cast<std::uint32_t>(arg.seed), static_cast<std::uint32_t>(arg.seed >> 32),
+                    static_cast<std::uint32_t>(path_value), static_cast<std::uint32_t>(path_value >> 32)
+                };
+                return std::mt19937_64{ seeds };
+            }();
+            resample(history, path, arg.block_size, rng);
+
+            auto features = backtest::features_type{ std::allocator_arg, arena.allocator() };
+            auto automatas = backtest::make_array_of_variants<automatas_types...>(initial_amount);
+            std::array<double, automatas_quantity> max_capitals;
+            std::array<double, automatas_quantity> max_drawdowns{};
+            std::array<bool, automatas_quantity> is_bankrupt{};
+            max_capitals.fill(initial_amount);
+
+            for (const auto & latest_record : path) {
+                backtest::update(features, latest_record);
+                for (std::size_t index = 0; index < automatas_quantity; ++index) {
+                    if (is_bankrupt[index])
+                        continue;
+                    std::visit([&](auto & value){
+                        try {
+                            value.update(latest_record);
+                        }
+                        catch (const automata::bankruptcy_error &) {
+                            is_bankrupt[index] = true;
+                            max_drawdowns[index] = 1.0;
+                            return;
+                        }
+                        backtest::process(features, value);
+
+                        const auto capital = static_cast<double>(value.total_capital());
+                        max_capitals[index] = std::max(max_capitals[index], capital);
+                        max_drawdowns[index] = std::max(max_drawdowns[index], 1.0 - (capital / max_capitals[index]));
+                    }, automatas[index]);
+                }
+            }
+
+            for (std::size_t index = 0; index < automatas_quantity; ++index) {
+                capital_samples[index][path_index] = is_bankrupt[index]
+                    ? 0.0
+                    : std::visit([](const auto & value){ return static_cast<double>(value.total_capital()); }, automatas[index])
+                ;
+                drawdown_samples[index][path_index] = max_drawdowns[index];
+            }
+        };
+
+        std::atomic<std::size_t> next_path_index = 0;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        {
+            std::vector<std::jthread> workers;
+            const auto workers_quantity = std::clamp(arg.threads, std::size_t{ 1 }, arg.paths);
+            if (arg.report)
+                *arg.report = workers_report{
+                    .paths = std::vector<std::size_t>(workers_quantity, 0),
+                    .upstream_allocations = std::vector<std::size_t>(workers_quantity, 0),
+                    .arena_growths = std::vector<std::size_t>(workers_quantity, 0)
+                };
+            for (std::size_t worker_index = 0; worker_index < workers_quantity; ++worker_index)
+                workers.emplace_back([&, worker_index](){
+                    try {
+                        auto path = std::vector<record_type>(path_length);
+                        auto arena = details::memory::arena{}; // per-path states
+                        std::size_t paths_processed = 0;
+                        for (auto path_index = next_path_index++; path_index < arg.paths; path_index = next_path_index++) {
+                            run_path(path_index, path, arena);
+                            arena.reset();
+                            ++paths_processed;
+                        }
+                        if (arg.report) { // one element per worker
+                            arg.report->paths[worker_index] = paths_processed;
+                            arg.report->upstream_allocations[worker_index] = arena.upstream_allocations();
+                            arg.report->arena_growths[worker_index] = arena.growths();
+                        }
+                    }
+                    catch (...) {
+                        next_path_index = arg.paths; // stops other workers
+                        auto lock = std::scoped_lock{ error_mutex };
+                        if (not error)
+                            error = std::current_exception();
+                    }
+                });
+        } // join
+        if (error)
+            std::rethrow_exception(error);
+
+        std::array<automata_result, automatas_quantity> results;
+        [&]<std::size_t ... indexes>(std::index_sequence<indexes...>){
+            ((results[indexes].name = gcl::cx::type_name_v<automatas_types>), ...);
+        }(std::make_index_sequence<automatas_quantity>{});
+        for (std::size_t index = 0; index < automatas_quantity; ++index) {
+            std::sort(std::begin(capital_samples[index]), std::end(capital_samples[index]));
+            std::sort(std::begin(drawdown_samples[index]), std::end(drawdown_samples[index]));
+            results[index].total_capital.values = std::move(capital_samples[index]);
+            results[index].max_drawdown.values = std::move(drawdown_samples[index]);
+        }
+        return results;
+    }
+}
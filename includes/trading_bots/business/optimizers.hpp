@@ -0,0 +1,150 @@
+#pragma once
+
+#include <trading_bots/business/automatas.hpp>
+#include <trading_bots/business/backtest.hpp>
+
+#include <gcl/cx/type_name.hpp>
+
+#include <stack>
+#include <vector>
+#include <variant>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+namespace trading_bots::optimizers {
+
+    struct successive_halving_settings {
+        std::size_t checkpoints = 4;    // evenly spaced over the records
+        float pruning_rate = 0.5f;      // ]0, 1[ : fraction of the survivors pruned at each checkpoint
+        std::size_t min_survivors = 1;
+
+        void ensure_datas_integrity() const {
+            if (pruning_rate <= 0.f or pruning_rate >= 1.f)
+                throw std::invalid_argument{"successive_halving_settings : pruning_rate must be ]0, 1["};
+            if (min_survivors == 0)
+                throw std::invalid_argument{"successive_halving_settings : min_survivors == 0"};
+        }
+    };
+
+    struct candidate_result {
+        std::string_view name;
+        automata::amount_type total_capital;    // when pruned, or at the end of the records
+        std::size_t records_processed;
+        bool is_bankrupt;
+    };
+
+    // Runs all candidates on the records (same order as run_for_datas : top first),
+    // and at each checkpoint only keeps the best performers (by total capital).
+    // Bankrupt candidates are pruned as soon as they are.
+    //
+    // Results : survivors first, then pruned candidates from the latest to the earliest pruned,
+    //  each group sorted by total capital.
+    template <automata::automata_type ... automatas_types>
+    auto successive_halving(
+        std::stack<backtest::record_type> records,
+        const float initial_amount,
+        const successive_halving_settings settings = {}
+    ) {
+        settings.ensure_datas_integrity();
+
+        using element_type = std::variant<automatas_types...>;
+        auto candidates = [&](){
+            auto values = backtest::make_array_of_variants<automatas_types...>(initial_amount);
+            return std::vector<element_type>(
+                std::make_move_iterator(std::begin(values)),
+                std::make_move_iterator(std::end(values))
+            );
+        }();
+        auto features = backtest::features_type{};
+
+        std::vector<candidate_result> pruned;
+        pruned.reserve(std::size(candidates));
+        const auto make_result = [](const element_type & element, std::size_t records_processed) {
+            return std::visit([records_processed](const auto & value){
+                return candidate_result{
+                    .name = gcl::cx::type_name_v<std::remove_cvref_t<decltype(value)>>,
+                    .total_capital = value.total_capital(),
+                    .records_processed = records_processed,
+                    .is_bankrupt = value.is_bankrupt()
+                };
+            }, element);
+        };
+        const auto by_total_capital = [](const element_type & lhs, const element_type & rhs) {
+            return std::visit([](const auto & lhs_value, const auto & rhs_value){
+                return lhs_value.total_capital() > rhs_value.total_capital();
+            }, lhs, rhs);
+        };
+
+        const auto records_quantity = std::size(records);
+        const auto checkpoint_interval = std::max(records_quantity / (settings.checkpoints + 1), std::size_t{ 1 });
+
+        std::size_t records_processed = 0;
+        while (not records.empty() and not candidates.empty()) {
+
+            const auto latest_record = [&records](){
+                auto value = std::move(records.top());
+                records.pop();
+                return value;
+            }();
+            ++records_processed;
+
+            backtest::update(features, latest_record);
+            for (auto & element : candidates)
+                std::visit([&](auto & value){
+                    try {
+                        value.update(latest_record);
+                    }
+                    catch (const automata::bankruptcy_error &) {
+                        return; // pruned below
+                    }
+                    backtest::process(features, value);
+                }, element);
+
+            const auto bankrupts_begin = std::stable_partition(std::begin(candidates), std::end(candidates), [](const auto & element){
+                return std::visit([](const auto & value){ return not value.is_bankrupt(); }, element);
+            });
+            for (auto it = bankrupts_begin; it not_eq std::end(candidates); ++it)
+                pruned.push_back(make_result(*it, records_processed));
+            candidates.erase(bankrupts_begin, std::end(candidates));
+
+            const bool is_checkpoint =
+                records_processed % checkpoint_interval == 0 and
+                records_processed / checkpoint_interval <= settings.checkpoints
+            ;
+            if (not is_checkpoint)
+                continue;
+
+            const auto survivors_quantity = std::max(
+                settings.min_survivors,
+                static_cast<std::size_t>(std::ceil(std::size(candidates) * (1.f - settings.pruning_rate)))
+            );
+            if (survivors_quantity >= std::size(candidates))
+                continue;
+            std::stable_sort(std::begin(candidates), std::end(candidates), by_total_capital);
+            std::transform(
+                std::next(std::begin(candidates), survivors_quantity), std::end(candidates),
+                std::back_inserter(pruned),
+                [&](const auto & element){ return make_result(element, records_processed); }
+            );
+            candidates.erase(std::next(std::begin(candidates), survivors_quantity), std::end(candidates));
+        }
+
+        std::vector<candidate_result> results;
+        results.reserve(std::size(candidates) + std::size(pruned));
+        std::stable_sort(std::begin(candidates), std::end(candidates), by_total_capital);
+        std::transform(std::cbegin(candidates), std::cend(candidates), std::back_inserter(results), [&](const auto & element){
+            return make_result(element, records_processed);
+        });
+        std::stable_sort(std::begin(pruned), std::end(pruned), [](const auto & lhs, const auto & rhs){
+            return lhs.records_processed not_eq rhs.records_processed
+                ? lhs.records_processed > rhs.records_processed
+                : lhs.total_capital > rhs.total_capital
+            ;
+        });
+        std::move(std::begin(pruned), std::end(pruned), std::back_inserter(results));
+        return results;
+    }
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <trading_bots/business/data_types.hpp>
+#include <trading_bots/business/automatas.hpp>
+
+#include <vector>
+#include <array>
+#include <span>
+#include <tuple>
+#include <numeric>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+#include <concepts>
+#include <stdexcept>
+
+// Multi-asset backtests :
+//  - aligned_feeds : many assets' records, aligned on the union of their dates
+//  - wallet        : positions over many assets, as structure-of-arrays (quantities[], prices[])
+//  - base          : portfolio automatas, which process sees every asset at each tick
+//
+// Single-asset automatas (automata::base) are unchanged.
+
+namespace trading_bots::portfolio {
+
+    using record_type = business::data_types::record;
+    using amount_type = business::data_types::amount_type;
+    using timestamp_type = record_type::timestamp_type;
+
+    // Records of many assets, on a common timeline : the union of their dates.
+    // Closes are a row-major [tick][asset] matrix, so a tick's prices are contiguous.
+    // An asset without a record at some tick keeps its latest close.
+    // Before its first record and after its last one, its close is 0 : not listed (so, not tradable).
+    struct aligned_feeds {
+
+        // [assets] : chronological records of each asset (see backtest::to_chronological), which must outlive this
+        explicit aligned_feeds(std::vector<std::span<const record_type>> assets)
+        : assets_quantity{ std::size(assets) }
+        {
+            std::vector<std::vector<timestamp_type>> assets_timestamps;
+            assets_timestamps.reserve(assets_quantity);
+            for (const auto & records : assets) {
+                auto & values = assets_timestamps.emplace_back();
+                values.reserve(std::size(records));
+                for (const auto & value : records)
+                    values.push_back(value.timestamp());
+                if (not std::is_sorted(std::cbegin(values), std::cend(values)))
+                    throw std::invalid_argument{"portfolio::aligned_feeds : records are not chronological"};
+                timestamps.insert(std::end(timestamps), std::cbegin(values), std::cend(values));
+            }
+            std::sort(std::begin(timestamps), std::end(timestamps));
+            timestamps.erase(std::unique(std::begin(timestamps), std::end(timestamps)), std::end(timestamps));
+
+            closes_matrix.resize(std::size(timestamps) * assets_quantity, 0.f);
+            records_matrix.resize(std::size(timestamps) * assets_quantity, nullptr);
+            for (std::size_t asset = 0; asset < assets_quantity; ++asset) {
+                std::size_t position = 0;
+                float latest_close = 0;
+                for (std::size_t tick = 0; tick < std::size(timestamps); ++tick) {
+                    // duplicated dates : the last record of the date
+                    for (; position < std::size(assets[asset]) and assets_timestamps[asset][position] == timestamps[tick]; ++position) {
+                        records_matrix[tick * assets_quantity + asset] = &assets[asset][position];
+                        latest_close = assets[asset][position].CloseLast;
+                    }
+                    closes_matrix[tick * assets_quantity + asset] = latest_close;
+                }
+                // delisted after its last record
+                if (not assets[asset].empty()) {
+                    const auto last_timestamp = assets_timestamps[asset].back();
+                    const auto last_tick = static_cast<std::size_t>(std::distance(
+                        std::cbegin(timestamps),
+                        std::lower_bound(std::cbegin(timestamps), std::cend(timestamps), last_timestamp)
+                    ));
+                    for (std::size_t tick = last_tick + 1; tick < std::size(timestamps); ++tick)
+                        closes_matrix[tick * assets_quantity + asset] = 0.f;
+                }
+            }
+        }
+
+        std::size_t size() const {
+            return std::size(timestamps);
+        }
+        std::size_t assets() const {
+            return assets_quantity;
+        }
+        timestamp_type timestamp(std::size_t tick) const {
+            return timestamps[tick];
+        }
+        std::span<const float> closes(std::size_t tick) const {
+            return std::span{ closes_matrix }.subspan(tick * assets_quantity, assets_quantity);
+        }
+        // nullptr if [asset] has no record at [tick]
+        const record_type * record_of(std::size_t tick, std::size_t asset) const {
+            return records_matrix[tick * assets_quantity + asset];
+        }
+
+    private:
+        std::size_t assets_quantity;
+        std::vector<timestamp_type> timestamps;
+        std::vector<float> closes_matrix;
+        std::vector<const record_type *> records_matrix;
+    };
+
+    // Positions over many assets, as structure-of-arrays.
+    // Revaluation is a dot product over contiguous arrays, with independent partial sums so the compiler can vectorize it.
+    struct wallet {
+
+        explicit wallet(std::size_t assets_quantity)
+        : quantities(assets_quantity, amount_type{ 0 })
+        , prices(assets_quantity, amount_type{ 0 })
+        {}
+
+        std::size_t size() const {
+            return std::size(quantities);
+        }
+
+        void update(std::span<const float> closes) {
+            if (std::size(closes) not_eq size())
+                throw std::invalid_argument{"portfolio::wallet::update : assets quantity mismatch"};
+            std::copy(std::cbegin(closes), std::cend(closes), std::begin(prices));
+        }
+        amount_type to_USDT() const {
+            constexpr std::size_t lanes = 4;
+            std::array<amount_type, lanes> partial_sums{};
+            const auto vectorized_size = size() - (size() % lanes);
+            for (std::size_t index = 0; index < vectorized_size; index += lanes)
+                for (std::size_t lane = 0; lane < lanes; ++lane)
+                    partial_sums[lane] += quantities[index + lane] * prices[index + lane];
+            for (std::size_t index = vectorized_size; index < size(); ++index)
+                partial_sums[0] += quantities[index] * prices[index];
+            return (partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3]);
+        }
+        amount_type to_USDT(std::size_t asset) const {
+            return quantities[asset] * prices[asset];
+        }
+        amount_type price(std::size_t asset) const {
+            return prices[asset];
+        }
+
+        void add_USDT_amount(std::size_t asset, amount_type amount) {
+            if (amount <= 0 or prices[asset] <= 0)
+                throw std::invalid_argument{"portfolio::wallet::add_USDT_amount"};
+            quantities[asset] += amount / prices[asset];
+        }
+        void remove_USDT_amount(std::size_t asset, amount_type amount) {
+            if (amount <= 0 or prices[asset] <= 0)
+                throw std::invalid_argument{"portfolio::wallet::remove_USDT_amount"};
+            quantities[asset] -= std::min(quantities[asset], amount / prices[asset]); // double precision
+        }
+
+    private:
+        std::vector<amount_type> quantities;
+        std::vector<amount_type> prices;
+    };
+
+    struct base {
+
+        base(amount_type initial_amount, std::size_t assets_quantity)
+        : current_amount_USD{ initial_amount }
+        , investements{ assets_quantity }
+        {}
+
+        // Positions of delisted assets (close turning to 0) are sold at their last close
+        void update(std::span<const float> closes) {
+            for (std::size_t asset = 0; asset < std::min(std::size(closes), investements.size()); ++asset)
+                if (closes[asset] <= 0 and investements.price(asset) > 0)
+                    sell_up_to(asset, investements.to_USDT(asset));
+            investements.update(closes);
+            if (is_bankrupt())
+                throw automata::bankruptcy_error{};
+        }
+
+        auto total_capital() const {
+            return investements.to_USDT() + current_amount_USD;
+        }
+        bool is_bankrupt() const {
+            return total_capital() <= 0;
+        }
+
+        void buy_up_to(std::size_t asset, amount_type value) {
+            const auto amount = std::min(value, current_amount_USD);
+            if (amount <= 0)
+                return;
+            current_amount_USD -= amount;
+            investements.add_USDT_amount(asset, amount);
+        }
+        void sell_up_to(std::size_t asset, amount_type value) {
+            const auto amount = std::min(value, investements.to_USDT(asset));
+            if (amount <= 0)
+                return;
+            current_amount_USD += amount;
+            investements.remove_USDT_amount(asset, amount);
+        }
+
+        // Trades toward [weights] (of the total capital, per asset; the rest is kept as USD) :
+        // sells first, so buys can use the released USD
+        void rebalance_to(std::span<const float> weights) {
+            if (std::size(weights) not_eq investements.size())
+                throw std::invalid_argument{"portfolio::base::rebalance_to : assets quantity mismatch"};
+            const auto capital = total_capital();
+            for (std::size_t asset = 0; asset < std::size(weights); ++asset) {
+                const amount_type target = capital * weights[asset];
+                if (const auto value = investements.to_USDT(asset); value > target)
+                    sell_up_to(asset, value - target);
+            }
+            for (std::size_t asset = 0; asset < std::size(weights); ++asset) {
+                const amount_type target = capital * weights[asset];
+                if (const auto value = investements.to_USDT(asset); value < target and investements.price(asset) > 0)
+                    buy_up_to(asset, target - value);
+            }
+        }
+
+    protected:
+        amount_type current_amount_USD;
+        wallet investements;
+    };
+
+    template <typename T>
+    concept automata_type =
+        std::derived_from<T, base> and
+        std::constructible_from<T, amount_type, std::size_t> and
+        requires (T & value, const aligned_feeds & feeds, std::size_t tick) { value.process(feeds, tick); }
+    ;
+
+    // Equal weights over listed assets, every [period] ticks
+    template <std::size_t period>
+    requires (period not_eq 0)
+    struct equal_weights : base {
+
+        equal_weights(amount_type initial_amount, std::size_t assets_quantity)
+        : base{ initial_amount, assets_quantity }
+        , weights(assets_quantity, 0.f)
+        {}
+
+        void process(const aligned_feeds & feeds, std::size_t tick) {
+            if (tick % period not_eq 0)
+                return;
+            const auto closes = feeds.closes(tick);
+            const auto listed = std::count_if(std::cbegin(closes), std::cend(closes), [](float value){ return value > 0; });
+            if (listed == 0)
+                return;
+            std::transform(std::cbegin(closes), std::cend(closes), std::begin(weights), [&](float value){
+                return value > 0 ? 1.f / static_cast<float>(listed) : 0.f;
+            });
+            rebalance_to(weights);
+        }
+
+    private:
+        std::vector<float> weights;
+    };
+
+    // Cross-sectional momentum : equal weights over the [top] assets which closes rose the most
+    // over the latest [lookback] ticks, every [period] ticks
+    template <std::size_t lookback, std::size_t top, std::size_t period>
+    requires (lookback not_eq 0 and top not_eq 0 and period not_eq 0)
+    struct momentum : base {
+
+        momentum(amount_type initial_amount, std::size_t assets_quantity)
+        : base{ initial_amount, assets_quantity }
+        , weights(assets_quantity, 0.f)
+        , returns(assets_quantity, 0.f)
+        , ranks(assets_quantity)
+        {}
+
+        void process(const aligned_feeds & feeds, std::size_t tick) {
+            if (tick < lookback or tick % period not_eq 0)
+                return;
+            const auto closes = feeds.closes(tick);
+            const auto past_closes = feeds.closes(tick - lookback);
+            for (std::size_t asset = 0; asset < std::size(closes); ++asset)
+                returns[asset] = (closes[asset] > 0 and past_closes[asset] > 0)
+                    ? (closes[asset] / past_closes[asset]) - 1
+                    : -std::numeric_limits<float>::infinity() // not ranked
+                ;
+
+            std::iota(std::begin(ranks), std::end(ranks), std::size_t{ 0 });
+            const auto selected_quantity = std::min(top, std::size(ranks));
+            std::nth_element(std::begin(ranks), std::begin(ranks) + (selected_quantity - 1), std::end(ranks), [&](std::size_t lhs, std::size_t rhs){
+                return returns[lhs] > returns[rhs];
+            });
+
+            std::fill(std::begin(weights), std::end(weights), 0.f);
+            const auto selected = std::span{ ranks }.first(selected_quantity);
+            const auto ranked = std::count_if(std::cbegin(selected), std::cend(selected), [&](std::size_t asset){
+                return returns[asset] not_eq -std::numeric_limits<float>::infinity();
+            });
+            for (const auto asset : selected)
+                if (returns[asset] not_eq -std::numeric_limits<float>::infinity())
+                    weights[asset] = 1.f / static_cast<float>(ranked);
+            rebalance_to(weights);
+        }
+
+    private:
+        std::vector<float> weights;
+        std::vector<float> returns;
+        std::vector<std::size_t> ranks;
+    };
+
+    // Processes [feeds] with each automata, without dispatch : returns them, to read their results.
+    // A bankrupt automata is not processed anymore, and keeps reporting is_bankrupt().
+    template <automata_type ... automatas_types>
+    auto run(const aligned_feeds & feeds, amount_type initial_amount) {
+        auto automatas = std::tuple<automatas_types...>{ automatas_types{ initial_amount, feeds.assets() }... };
+        const auto process = [&feeds](auto & value, std::size_t tick) {
+            if (value.is_bankrupt())
+                return;
+            try {
+                value.update(feeds.closes(tick));
+            }
+            catch (const automata::bankruptcy_error &) {
+                return;
+            }
+            value.process(feeds, tick);
+        };
+        for (std::size_t tick = 0; tick < feeds.size(); ++tick)
+            std::apply([&](auto & ... value){
+                (process(value, tick), ...);
+            }, automatas);
+        return automatas;
+    }
+
+    // --- contract checks
+    static_assert(automata_type<equal_weights<1>>);
+    static_assert(automata_type<momentum<14, 3, 7>>);
+}
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <trading_bots/business/automatas.hpp>
+#include <trading_bots/business/data_types.hpp>
+
+#include <bit>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <ranges>
+#include <utility>
+#include <algorithm>
+#include <filesystem>
+#include <type_traits>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+// Columnar results file : equity curves and orders ledgers of many automatas runs.
+//
+//  "TBRS" version
+//  run blocks   : points, timestamps (zigzag varint deltas), capitals (float32),
+//                 orders, timestamps (zigzag varint deltas), sides (uint8), amounts (float64), prices (float64)
+//  index        : per run, its metadata and block location
+//  trailer      : index offset, "TBRS"
+//
+// Top-N queries only read the trailer and the index.
+
+namespace trading_bots::results::encoding {
+
+    static_assert(std::endian::native == std::endian::little, "results::encoding : little-endian only");
+
+    void put(std::string & buffer, const auto & value)
+    requires std::is_trivially_copyable_v<std::remove_cvref_t<decltype(value)>>
+    {
+        buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+    inline void put_varint(std::string & buffer, std::uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+    inline void put_zigzag(std::string & buffer, std::int64_t value) {
+        put_varint(buffer, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+    inline void put_string(std::string & buffer, std::string_view value) {
+        put_varint(buffer, std::size(value));
+        buffer.append(value);
+    }
+
+    struct cursor {
+        std::string_view input;
+
+        template <typename T>
+        requires std::is_trivially_copyable_v<T>
+        T get() {
+            ensure_available(sizeof(T));
+            T value;
+            std::memcpy(&value, std::data(input), sizeof(T));
+            input.remove_prefix(sizeof(T));
+            return value;
+        }
+        std::uint64_t get_varint() {
+            std::uint64_t value = 0;
+            for (std::size_t shift = 0; shift < 64; shift += 7) {
+                const auto byte = get<std::uint8_t>();
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+            throw std::runtime_error{"results::encoding : corrupted varint"};
+        }
+        std::int64_t get_zigzag() {
+            const auto value = get_varint();
+            return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+        }
+        std::string get_string() {
+            const auto size = get_varint();
+            ensure_available(size);
+            auto value = std::string{ input.substr(0, size) };
+            input.remove_prefix(size);
+            return value;
+        }
+
+    private:
+        void ensure_available(std::size_t size) const {
+            if (std::size(input) < size)
+                throw std::runtime_error{"results::encoding : truncated input"};
+        }
+    };
+}
+
+namespace trading_bots::results {
+
+    constexpr std::uint32_t magic = 0x53524254; // "TBRS"
+    constexpr std::uint32_t version = 1;
+
+    struct run {
+        std::string name;               // automata type, including its template (strategy) parameters
+        std::string parameters;         // free-form : dataset, settings, ...
+        double initial_capital = 0;
+        double final_capital = 0;
+        std::uint64_t records_quantity = 0;
+        std::uint32_t resolution = 1;   // one equity point every [resolution] records, plus the last one
+
+        std::vector<std::int64_t> timestamps; // seconds since epoch
+        std::vector<float> capitals;
+        automata::ledger_type orders;
+    };
+
+    // Records the equity curve and orders of one automata, while it is backtested.
+    struct recorder {
+
+        using timestamp_type = business::data_types::record::timestamp_type;
+
+        recorder()
+        : recorder{ 1 }
+        {}
+        explicit recorder(std::uint32_t resolution)
+        {
+            if (resolution == 0)
+                throw std::invalid_argument{"results::recorder : resolution == 0"};
+            value.resolution = resolution;
+        }
+        recorder(const recorder &) = delete; // attached automatas point to this
+        recorder & operator=(const recorder &) = delete;
+
+        void attach(automata::base & automata_value) {
+            automata_value.record_orders_into(&value.orders);
+        }
+        // once per record, after the automata processed it
+        void update(timestamp_type timestamp, double capital) {
+            const auto seconds = timestamp.time_since_epoch().count();
+            for (auto it = std::next(std::begin(value.orders), stamped_orders); it not_eq std::end(value.orders); ++it)
+                it->timestamp = seconds;
+            stamped_orders = std::size(value.orders);
+
+            last_point = { seconds, static_cast<float>(capital) };
+            if (value.records_quantity++ % value.resolution == 0) {
+                value.timestamps.push_back(last_point.first);
+                value.capitals.push_back(last_point.second);
+            }
+        }
+        run finish(std::string name, double initial_capital, double final_capital, std::string parameters = {}) {
+            if (value.records_quantity not_eq 0 and (value.records_quantity - 1) % value.resolution not_eq 0) {
+                value.timestamps.push_back(last_point.first);
+                value.capitals.push_back(last_point.second);
+            }
+            value.name = std::move(name);
+            value.parameters = std::move(parameters);
+            value.initial_capital = initial_capital;
+            value.final_capital = final_capital;
+            return std::move(value);
+        }
+
+    private:
+        run value;
+        std::size_t stamped_orders = 0;
+        std::pair<std::int64_t, float> last_point;
+    };
+
+    struct entry {
+        std::string name;
+        std::string parameters;
+        double initial_capital;
+        double final_capital;
+        std::uint64_t records_quantity;
+        std::uint32_t resolution;
+        std::uint64_t points_quantity;
+        std::uint64_t orders_quantity;
+        std::uint64_t block_offset;
+        std::uint64_t block_size;
+    };
+
+    struct writer {
+
+        explicit writer(const std::filesystem::path & path)
+        : ofs{ path, std::ios::binary | std::ios::trunc }
+        {
+            if (not ofs.is_open())
+                throw std::invalid_argument{"results::writer : cannot open " + path.string()};
+            encoding::put(buffer, magic);
+            encoding::put(buffer, version);
+            flush();
+        }
+        writer(const writer &) = delete;
+        writer & operator=(const writer &) = delete;
+        ~writer() {
+            try {
+                close();
+            }
+            catch (...) {} // use close() to get errors
+        }
+
+        void write(const run & value) {
+            if (std::size(value.timestamps) not_eq std::size(value.capitals))
+                throw std::invalid_argument{"results::writer : timestamps/capitals size mismatch"};
+            if (closed)
+                throw std::logic_error{"results::writer : closed"};
+
+            buffer.clear();
+            const auto put_deltas = [this](auto && timestamps) {
+                std::int64_t previous = 0;
+                for (const auto timestamp : timestamps) {
+                    encoding::put_zigzag(buffer, timestamp - previous);
+                    previous = timestamp;
+                }
+            };
+
+            encoding::put_varint(buffer, std::size(value.timestamps));
+            put_deltas(value.timestamps);
+            buffer.append(reinterpret_cast<const char *>(std::data(value.capitals)), std::size(value.capitals) * sizeof(float));
+
+            encoding::put_varint(buffer, std::size(value.orders));
+            put_deltas(value.orders | std::views::transform(&automata::order::timestamp));
+            for (const auto & order : value.orders)
+                encoding::put(buffer, static_cast<std::uint8_t>(order.side));
+            for (const auto & order : value.orders)
+                encoding::put(buffer, order.amount);
+            for (const auto & order : value.orders)
+                encoding::put(buffer, order.price);
+
+            index.push_back(entry{
+                .name = value.name,
+                .parameters = value.parameters,
+                .initial_capital = value.initial_capital,
+                .final_capital = value.final_capital,
+                .records_quantity = value.records_quantity,
+                .resolution = value.resolution,
+                .points_quantity = std::size(value.timestamps),
+                .orders_quantity = std::size(value.orders),
+                .block_offset = offset,
+                .block_size = std::size(buffer)
+            });
+            flush();
+        }
+
+        void close() {
+            if (closed)
+                return;
+            closed = true;
+
+            const auto index_offset = offset;
+            buffer.clear();
+            encoding::put_varint(buffer, std::size(index));
+            for (const auto & value : index) {
+                encoding::put_string(buffer, value.name);
+                encoding::put_string(buffer, value.parameters);
+                encoding::put(buffer, value.initial_capital);
+                encoding::put(buffer, value.final_capital);
+                encoding::put(buffer, value.records_quantity);
+                encoding::put(buffer, value.resolution);
+                encoding::put(buffer, value.points_quantity);
+                encoding::put(buffer, value.orders_quantity);
+                encoding::put(buffer, value.block_offset);
+                encoding::put(buffer, value.block_size);
+            }
+            encoding::put(buffer, index_offset);
+            encoding::put(buffer, magic);
+            flush();
+            ofs.close();
+        }
+
+    private:
+        std::ofstream ofs;
+        std::string buffer;
+        std::uint64_t offset = 0;
+        std::vector<entry> index;
+        bool closed = false;
+
+        void flush() {
+            if (not ofs.write(std::data(buffer), std::size(buffer)))
+                throw std::runtime_error{"results::writer : cannot write"};
+            offset += std::size(buffer);
+        }
+    };
+
+    struct reader {
+
+        explicit reader(const std::filesystem::path & path)
+        : ifs{ path, std::ios::binary }
+        {
+            if (not ifs.is_open())
+                throw std::invalid_argument{"results::reader : cannot open " + path.string()};
+
+            constexpr auto header_size = sizeof(magic) + sizeof(version);
+            constexpr auto trailer_size = sizeof(std::uint64_t) + sizeof(magic);
+            const auto file_size = std::filesystem::file_size(path);
+            if (file_size < header_size + trailer_size)
+                throw std::runtime_error{"results::reader : truncated file"};
+
+            auto header = encoding::cursor{ read(0, header_size) };
+            if (header.get<std::uint32_t>() not_eq magic or header.get<std::uint32_t>() not_eq version)
+                throw std::runtime_error{"results::reader : bad header"};
+
+            auto trailer = encoding::cursor{ read(file_size - trailer_size, trailer_size) };
+            const auto index_offset = trailer.get<std::uint64_t>();
+            if (trailer.get<std::uint32_t>() not_eq magic or index_offset > file_size - trailer_size)
+                throw std::runtime_error{"results::reader : bad trailer (not closed ?)"};
+
+            const auto index_buffer = read(index_offset, file_size - trailer_size - index_offset);
+            auto index_cursor = encoding::cursor{ index_buffer };
+            index.resize(index_cursor.get_varint());
+            for (auto & value : index) {
+                value.name = index_cursor.get_string();
+                value.parameters = index_cursor.get_string();
+                value.initial_capital = index_cursor.get<double>();
+                value.final_capital = index_cursor.get<double>();
+                value.records_quantity = index_cursor.get<std::uint64_t>();
+                value.resolution = index_cursor.get<std::uint32_t>();
+                value.points_quantity = index_cursor.get<std::uint64_t>();
+                value.orders_quantity = index_cursor.get<std::uint64_t>();
+                value.block_offset = index_cursor.get<std::uint64_t>();
+                value.block_size = index_cursor.get<std::uint64_t>();
+            }
+        }
+
+        const std::vector<entry> & entries() const {
+            return index;
+        }
+        // best final capitals first
+        std::vector<entry> top(std::size_t quantity) const {
+            quantity = std::min(quantity, std::size(index));
+            std::vector<entry> values(quantity);
+            std::partial_sort_copy(
+                std::cbegin(index), std::cend(index),
+                std::begin(values), std::end(values),
+                [](const auto & lhs, const auto & rhs){ return lhs.final_capital > rhs.final_capital; }
+            );
+            return values;
+        }
+
+        // only reads [value]'s block
+        run load(const entry & value) {
+            const auto block = read(value.block_offset, value.block_size);
+            auto input = encoding::cursor{ block };
+
+            auto result = run{
+                .name = value.name,
+                .parameters = value.parameters,
+                .initial_capital = value.initial_capital,
+                .final_capital = value.final_capital,
+                .records_quantity = value.records_quantity,
+                .resolution = value.resolution,
+                .timestamps = {},
+                .capitals = {},
+                .orders = {}
+            };
+            const auto get_deltas = [&input](std::size_t quantity, auto && output) {
+                std::int64_t previous = 0;
+                for (std::size_t i = 0; i < quantity; ++i)
+                    output(previous += input.get_zigzag());
+            };
+
+            const auto points_quantity = input.get_varint();
+            result.timestamps.reserve(points_quantity);
+            get_deltas(points_quantity, [&](auto timestamp){ result.timestamps.push_back(timestamp); });
+            result.capitals.resize(points_quantity);
+            for (auto & capital : result.capitals)
+                capital = input.get<float>();
+
+            result.orders.resize(input.get_varint());
+            auto order_it = std::begin(result.orders);
+            get_deltas(std::size(result.orders), [&](auto timestamp){ (order_it++)->timestamp = timestamp; });
+            for (auto & order : result.orders)
+                order.side = static_cast<automata::order::side_type>(input.get<std::uint8_t>());
+            for (auto & order : result.orders)
+                order.amount = input.get<double>();
+            for (auto & order : result.orders)
+                order.price = input.get<double>();
+            return result;
+        }
+
+    private:
+        std::ifstream ifs;
+        std::vector<entry> index;
+
+        std::string read(std::uint64_t offset, std::uint64_t size) {
+            std::string value(size, '\0');
+            ifs.seekg(static_cast<std::streamoff>(offset));
+            if (not ifs.read(std::data(value), static_cast<std::streamsize>(size)))
+                throw std::runtime_error{"results::reader : cannot read"};
+            return value;
+        }
+    };
+}
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <trading_bots/business/automatas.hpp>
+#include <trading_bots/business/indices.hpp>
+#include <trading_bots/details/mp.hpp>
+
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <concepts>
+#include <type_traits>
+
+// Strategies composed from rules, instead of hand-written automatas :
+//
+//  using namespace trading_bots::automata::rules;
+//  using my_strategy = trading_bots::automata::composed<
+//      when(trend<14>(2.f) == up   and rsi<14>() < 30).buy(.5f),
+//      when(trend<14>(2.f) == down and rsi<14>() > 70).sell(.5f),
+//      when(rsi<7>() < 50).buy(1 - rsi<7>() / 50)
+//  >;
+//
+// Rules are values of structural types (so, template arguments) :
+// the whole strategy is a type, which components_type is deduced from the indices its rules read,
+// and which process is the rules evaluation inlined in one function. No virtual, nor variant dispatch.
+//
+// Each expression evaluates to a maybe<T> : invalid when an index is not available yet (not enough records).
+// A rule with an invalid condition or amount does nothing, as hand-written automatas return early.
+
+namespace trading_bots::automata::rules {
+
+    template <typename T>
+    struct maybe {
+        bool is_valid;
+        T value;
+    };
+
+    template <typename T>
+    concept expression_type = requires {
+        typename T::components_type;
+        typename T::value_type;
+        requires T::is_expression;
+    };
+
+    // component of type T, from a tuple of T or T&
+    template <typename T>
+    constexpr const T & component(const auto & components) {
+        if constexpr (requires { std::get<T&>(components); })
+            return std::get<T&>(components);
+        else return std::get<T>(components);
+    }
+
+    // --- terminals
+
+    // Indices terminals read the default index (as backtest::features_type has it) :
+    // durations beyond its max_duration would never be available, so they do not compile.
+    template <typename>
+    constexpr inline std::size_t max_duration_of = 0;
+    template <template <std::size_t> typename index_type, std::size_t max_duration>
+    constexpr inline std::size_t max_duration_of<index_type<max_duration>> = max_duration;
+    template <template <std::size_t> typename terminal_type, std::size_t duration>
+    concept has_duration = requires { typename terminal_type<duration>; };
+
+    template <typename T>
+    struct constant {
+        constexpr static bool is_expression = true;
+        using value_type = T;
+        using components_type = std::tuple<>;
+
+        constexpr maybe<value_type> evaluate(const auto &) const {
+            return { true, value };
+        }
+        T value;
+    };
+
+    template <std::size_t duration>
+    requires (duration > 1 and duration <= max_duration_of<business::indices::rsi<>>)
+    struct rsi_of {
+        constexpr static bool is_expression = true;
+        using value_type = float;
+        using components_type = std::tuple<business::indices::rsi<>>;
+
+        constexpr maybe<value_type> evaluate(const auto & components) const {
+            const auto result = component<business::indices::rsi<>>(components).value_for_duration(duration);
+            return { result.has_value(), result ? static_cast<value_type>(*result) : value_type{} };
+        }
+    };
+    template <std::size_t duration>
+    constexpr auto rsi() {
+        return rsi_of<duration>{};
+    }
+
+    template <std::size_t duration>
+    requires (duration > 1 and duration <= max_duration_of<business::indices::trend<>>)
+    struct trend_of {
+        constexpr static bool is_expression = true;
+        using value_type = business::indices::trend_value_type;
+        using components_type = std::tuple<business::indices::trend<>>;
+
+        constexpr maybe<value_type> evaluate(const auto & components) const {
+            const auto result = component<business::indices::trend<>>(components).value_for_duration(duration, fluctuation_threshold);
+            return { result.has_value(), result.value_or(value_type::stable) };
+        }
+        float fluctuation_threshold;
+    };
+    template <std::size_t duration>
+    constexpr auto trend(float fluctuation_threshold) {
+        return trend_of<duration>{ fluctuation_threshold };
+    }
+    constexpr inline auto up = business::indices::trend_value_type::up;
+    constexpr inline auto stable = business::indices::trend_value_type::stable;
+    constexpr inline auto down = business::indices::trend_value_type::down;
+
+    template <std::size_t duration>
+    requires (duration > 1 and duration <= max_duration_of<business::indices::roc<>>)
+    struct roc_of {
+        constexpr static bool is_expression = true;
+        using value_type = float;
+        using components_type = std::tuple<business::indices::roc<>>;
+
+        constexpr maybe<value_type> evaluate(const auto & components) const {
+            const auto result = component<business::indices::roc<>>(components).value_for_duration(duration);
+            return { result.has_value(), result.value_or(value_type{}) };
+        }
+    };
+    template <std::size_t duration>
+    constexpr auto roc() {
+        return roc_of<duration>{};
+    }
+
+    // --- operators
+
+    // expressions as-is, numbers as constant<float>, trend values as constant<trend_value_type>
+    constexpr auto as_expression(auto value) {
+        using value_type = decltype(value);
+        if constexpr (expression_type<value_type>)
+            return value;
+        else if constexpr (std::is_enum_v<value_type>)
+            return constant<value_type>{ value };
+        else {
+            static_assert(std::is_arithmetic_v<value_type>, "rules : operand is neither an expression nor a number");
+            return constant<float>{ static_cast<float>(value) };
+        }
+    }
+    template <typename lhs_type, typename rhs_type>
+    concept operands_type = expression_type<lhs_type> or expression_type<rhs_type>;
+
+    // Both sides are evaluated (no short-circuit) : reads are cheap, and results combined without branches
+    template <typename operation_type, expression_type lhs_type, expression_type rhs_type>
+    struct binary {
+        constexpr static bool is_expression = true;
+        using value_type = decltype(operation_type{}(
+            std::declval<typename lhs_type::value_type>(),
+            std::declval<typename rhs_type::value_type>()
+        ));
+        using components_type = trading_bots::details::mp::tuple_union_t<
+            typename lhs_type::components_type,
+            typename rhs_type::components_type
+        >;
+
+        constexpr maybe<value_type> evaluate(const auto & components) const {
+            const auto lhs_value = lhs.evaluate(components);
+            const auto rhs_value = rhs.evaluate(components);
+            return {
+                static_cast<bool>(lhs_value.is_valid & rhs_value.is_valid),
+                operation_type{}(lhs_value.value, rhs_value.value)
+            };
+        }
+        lhs_type lhs;
+        rhs_type rhs;
+    };
+    template <expression_type operand_type>
+    requires std::same_as<typename operand_type::value_type, bool>
+    struct negation {
+        constexpr static bool is_expression = true;
+        using value_type = bool;
+        using components_type = typename operand_type::components_type;
+
+        constexpr maybe<value_type> evaluate(const auto & components) const {
+            const auto value = operand.evaluate(components);
+            return { value.is_valid, not value.value };
+        }
+        operand_type operand;
+    };
+
+    namespace operations {
+        // bitwise : both operands are evaluated anyway
+        struct logical_and {
+            constexpr bool operator()(bool lhs, bool rhs) const { return lhs & rhs; }
+        };
+        struct logical_or {
+            constexpr bool operator()(bool lhs, bool rhs) const { return lhs | rhs; }
+        };
+    }
+
+    template <typename operation_type, typename lhs_type, typename rhs_type>
+    constexpr auto make_binary(lhs_type lhs, rhs_type rhs) {
+        using lhs_expression_type = decltype(as_expression(lhs));
+        using rhs_expression_type = decltype(as_expression(rhs));
+        return binary<operation_type, lhs_expression_type, rhs_expression_type>{ as_expression(lhs), as_expression(rhs) };
+    }
+
+    // comparisons
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator<(lhs_type lhs, rhs_type rhs) { return make_binary<std::less<>>(lhs, rhs); }
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator<=(lhs_type lhs, rhs_type rhs) { return make_binary<std::less_equal<>>(lhs, rhs); }
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator>(lhs_type lhs, rhs_type rhs) { return make_binary<std::greater<>>(lhs, rhs); }
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator>=(lhs_type lhs, rhs_type rhs) { return make_binary<std::greater_equal<>>(lhs, rhs); }
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator==(lhs_type lhs, rhs_type rhs) { return make_binary<std::equal_to<>>(lhs, rhs); }
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator!=(lhs_type lhs, rhs_type rhs) { return make_binary<std::not_equal_to<>>(lhs, rhs); }
+
+    // arithmetic
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator+(lhs_type lhs, rhs_type rhs) { return make_binary<std::plus<>>(lhs, rhs); }
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator-(lhs_type lhs, rhs_type rhs) { return make_binary<std::minus<>>(lhs, rhs); }
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator*(lhs_type lhs, rhs_type rhs) { return make_binary<std::multiplies<>>(lhs, rhs); }
+    template <typename lhs_type, typename rhs_type> requires operands_type<lhs_type, rhs_type>
+    constexpr auto operator/(lhs_type lhs, rhs_type rhs) { return make_binary<std::divides<>>(lhs, rhs); }
+
+    // logical
+    template <expression_type lhs_type, expression_type rhs_type>
+    requires std::same_as<typename lhs_type::value_type, bool> and std::same_as<typename rhs_type::value_type, bool>
+    constexpr auto operator&&(lhs_type lhs, rhs_type rhs) { return make_binary<operations::logical_and>(lhs, rhs); }
+    template <expression_type lhs_type, expression_type rhs_type>
+    requires std::same_as<typename lhs_type::value_type, bool> and std::same_as<typename rhs_type::value_type, bool>
+    constexpr auto operator||(lhs_type lhs, rhs_type rhs) { return make_binary<operations::logical_or>(lhs, rhs); }
+    template <expression_type operand_type>
+    requires std::same_as<typename operand_type::value_type, bool>
+    constexpr auto operator!(operand_type operand) { return negation<operand_type>{ operand }; }
+
+    // --- rules
+
+    // when [condition], buys (or sells) [amount] times the available USD (or investment).
+    // [amount] is bounded to 1, and an amount <= 0 places no order.
+    template <order::side_type side_value, expression_type condition_type, expression_type amount_type>
+    requires std::same_as<typename condition_type::value_type, bool>
+    struct rule {
+        constexpr static auto side = side_value;
+        using components_type = trading_bots::details::mp::tuple_union_t<
+            typename condition_type::components_type,
+            typename amount_type::components_type
+        >;
+
+        condition_type condition;
+        amount_type amount;
+    };
+    template <typename T>
+    concept rule_type = requires (T value) {
+        []<order::side_type side_value, typename condition_type, typename amount_type>(rule<side_value, condition_type, amount_type>){}(value);
+    };
+
+    template <expression_type condition_type>
+    requires std::same_as<typename condition_type::value_type, bool>
+    struct when_type {
+        constexpr auto buy(auto amount) const {
+            return rule<order::side_type::buy, condition_type, decltype(as_expression(amount))>{ condition, as_expression(amount) };
+        }
+        constexpr auto sell(auto amount) const {
+            return rule<order::side_type::sell, condition_type, decltype(as_expression(amount))>{ condition, as_expression(amount) };
+        }
+        condition_type condition;
+    };
+    template <expression_type condition_type>
+    constexpr auto when(condition_type condition) {
+        return when_type<condition_type>{ condition };
+    }
+}
+
+namespace trading_bots::automata {
+
+    // Automata which process applies [rules_values...], in order. See automata::rules
+    template <auto ... rules_values>
+    requires (sizeof...(rules_values) not_eq 0) and (rules::rule_type<decltype(rules_values)> and ...)
+    struct composed : base {
+
+        using components_type = details::mp::tuple_union_t<
+            typename decltype(rules_values)::components_type...
+        >;
+
+        composed(amount_type initial_amount)
+        : base{ initial_amount }
+        {}
+
+        // components by reference (see backtest::process), or by value
+        void process(auto && components) {
+            (apply<rules_values>(components), ...);
+        }
+
+    private:
+        template <auto rule_value>
+        void apply(const auto & components) {
+            const auto condition = rule_value.condition.evaluate(components);
+            if (not (condition.is_valid & condition.value))
+                return;
+            const auto amount = rule_value.amount.evaluate(components);
+            if (not amount.is_valid or not (amount.value > 0)) // no order
+                return;
+            const auto rate = std::min(amount.value, decltype(amount.value){ 1 });
+
+            if constexpr (rule_value.side == order::side_type::buy)
+                buy_up_to(current_amount_USD * rate);
+            else
+                sell_up_to(investement.to_USDT() * rate);
+        }
+    };
+
+    // --- contract checks
+    static_assert(rules::max_duration_of<business::indices::rsi<>> == 14);
+    static_assert(not rules::has_duration<rules::rsi_of, 15>);
+    static_assert(not rules::has_duration<rules::trend_of, 15>);
+    static_assert(not rules::has_duration<rules::roc_of, 15>);
+    static_assert(rules::has_duration<rules::rsi_of, 14>);
+    static_assert(automata_type<composed<
+        rules::when(rules::trend<14>(2.f) == rules::up and rules::rsi<14>() < 30).buy(.5f),
+        rules::when(not (rules::roc<7>() > 0) or rules::rsi<14>() > 70).sell(1 - rules::rsi<14>() / 100)
+    >>);
+    static_assert(std::is_same_v<
+        composed<rules::when(rules::rsi<14>() < 30 and rules::trend<7>(1.f) != rules::down).buy(.5f)>::components_type,
+        std::tuple<business::indices::rsi<>, business::indices::trend<>>
+    >);
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <trading_bots/business/data_types.hpp>
+
+#include <vector>
+#include <map>
+#include <tuple>
+#include <span>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <optional>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+namespace trading_bots::business::indices {
+
+    // Whole-history indices columns, computed once per dataset by passes over the closes,
+    // then shared (read-only) by every run over that dataset. See rsi/trend/roc::use.
+    //
+    // Each value is bit-identical to the one the live index computes for the same record.
+    // Optionally persisted in [cache_directory], keyed by the cache format version, the dataset hash and the index parameters.
+    struct series {
+
+        using record_type = trading_bots::business::data_types::record;
+        using column_type = std::vector<float>;
+
+        enum class kind : std::uint8_t {
+            rsi, trend, roc
+        };
+
+        series(std::span<const record_type> chronological_records, std::optional<std::filesystem::path> cache_directory = std::nullopt)
+        : cache_directory{ std::move(cache_directory) }
+        {
+            closes.reserve(std::size(chronological_records));
+            for (const auto & value : chronological_records)
+                closes.push_back(value.CloseLast);
+
+            // FNV-1a
+            hash = 14695981039346656037ull;
+            const auto bytes = std::as_bytes(std::span{ closes });
+            for (const auto byte : bytes) {
+                hash ^= static_cast<std::uint64_t>(byte);
+                hash *= 1099511628211ull;
+            }
+        }
+
+        std::size_t size() const {
+            return std::size(closes);
+        }
+        std::uint64_t dataset_hash() const {
+            return hash;
+        }
+        const column_type & prices() const {
+            return closes;
+        }
+        // nullptr if not computed
+        const column_type * column(kind index, std::size_t max_duration, std::size_t duration) const {
+            const auto it = columns.find({ index, max_duration, duration });
+            return it == std::end(columns) ? nullptr : &(it->second);
+        }
+
+        // rsi<max_duration>::value_for_duration(duration), for durations [2, max_duration]
+        //
+        // rsi sums the oldest [duration] records of its cache, oldest first.
+        // For a given record, the window of [duration + 1] extends the one of [duration] by one variation,
+        // so each duration's column is the previous one's sums plus one variation per record :
+        // O(size * max_duration) for every column, in contiguous passes, and in the same summation order as rsi.
+        void compute_rsi(std::size_t max_duration) {
+
+            std::vector<std::size_t> missing_durations;
+            for (std::size_t duration = 2; duration <= max_duration; ++duration)
+                if (not try_emplace_cached({ kind::rsi, max_duration, duration }))
+                    missing_durations.push_back(duration);
+            if (missing_durations.empty())
+                return;
+
+            // variations[i] : from closes[i - 1] to closes[i], as rsi does
+            std::vector<double> gains(size(), 0.0);
+            std::vector<double> losses(size(), 0.0);
+            for (std::size_t i = 1; i < size(); ++i) {
+                const double variation = ((closes[i] / closes[i - 1]) * 100.0) - 100;
+                gains[i] = variation > .0 ? variation : .0;
+                losses[i] = variation < .0 ? std::fabs(variation) : .0;
+            }
+
+            std::vector<double> gain_sums(size(), 0.0);
+            std::vector<double> loss_sums(size(), 0.0);
+            auto missing_it = std::cbegin(missing_durations);
+            for (std::size_t duration = 2; duration <= max_duration; ++duration) {
+
+                auto values = column_type(size(), std::nanf(""));
+                const auto effective_duration = (duration - 1.0);
+                const auto update = [&](std::size_t i, std::size_t j) {
+                    gain_sums[i] += gains[j];
+                    loss_sums[i] += losses[j];
+                    const double result = 100.0 - (100.0 / (
+                        1.0 +
+                        (gain_sums[i] / effective_duration) / (loss_sums[i] / effective_duration)
+                    ));
+                    values[i] = static_cast<float>(result);
+                };
+                // rsi's cache : the latest min(i + 1, max_duration) records, from which the oldest [duration] ones are used.
+                // warm-up (cache not full yet) : oldest record is 0
+                const auto warmup_end = std::min(max_duration - 1, size());
+                for (std::size_t i = duration - 1; i < warmup_end; ++i)
+                    update(i, duration - 1);
+                // then the oldest record is i + 1 - max_duration
+                for (std::size_t i = std::max(duration - 1, max_duration - 1); i < size(); ++i)
+                    update(i, i + duration - max_duration);
+
+                if (missing_it not_eq std::cend(missing_durations) and *missing_it == duration) {
+                    const auto key = std::tuple{ kind::rsi, max_duration, duration };
+                    store(key, values);
+                    columns.emplace(key, std::move(values));
+                    ++missing_it;
+                }
+            }
+        }
+        // trend<max_duration> fluctuation rate, for durations [2, max_duration]
+        void compute_trend(std::size_t max_duration) {
+            for (std::size_t duration = 2; duration <= max_duration; ++duration)
+                emplace(kind::trend, max_duration, duration, [&](column_type & values){
+                    for (std::size_t i = duration; i < size(); ++i)
+                        values[i] = (closes[i] / closes[i - duration]) - 1;
+                });
+        }
+        // roc<max_duration>::value_for_duration(duration), for durations [2, max_duration]
+        void compute_roc(std::size_t max_duration) {
+            for (std::size_t duration = 2; duration <= max_duration; ++duration)
+                emplace(kind::roc, max_duration, duration, [&](column_type & values){
+                    for (std::size_t i = duration; i < size(); ++i)
+                        values[i] = ((closes[i] - closes[i - duration]) / closes[i - duration]) * 100;
+                });
+        }
+
+    private:
+
+        // Part of the cache files names : to increment whenever an index computation (or the file layout) changes,
+        // so previous files are never read
+        constexpr static std::uint32_t cache_format_version = 1;
+
+        column_type closes;
+        std::uint64_t hash;
+        std::optional<std::filesystem::path> cache_directory;
+        std::map<std::tuple<kind, std::size_t, std::size_t>, column_type> columns;
+
+        // values not available yet (see the live indices) are left as NaN, but never read
+        void emplace(kind index, std::size_t max_duration, std::size_t duration, auto && compute) {
+
+            const auto key = std::tuple{ index, max_duration, duration };
+            if (try_emplace_cached(key))
+                return;
+            auto values = column_type(size(), std::nanf(""));
+            compute(values);
+            store(key, values);
+            columns.emplace(key, std::move(values));
+        }
+        // true if [key]'s column is available : already computed, or loaded from the cache
+        bool try_emplace_cached(const std::tuple<kind, std::size_t, std::size_t> & key) {
+            if (columns.contains(key))
+                return true;
+            auto values = column_type(size(), std::nanf(""));
+            if (not load(key, values))
+                return false;
+            columns.emplace(key, std::move(values));
+            return true;
+        }
+
+        std::optional<std::filesystem::path> path_of(const std::tuple<kind, std::size_t, std::size_t> & key) const {
+            if (not cache_directory)
+                return std::nullopt;
+            const auto & [index, max_duration, duration] = key;
+            auto name = std::ostringstream{};
+            name
+                << 'v' << cache_format_version << '_'
+                << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec
+                << '_' << static_cast<int>(index) << '_' << max_duration << '_' << duration
+                << ".bin"
+            ;
+            return *cache_directory / name.str();
+        }
+        bool load(const std::tuple<kind, std::size_t, std::size_t> & key, column_type & values) const {
+            const auto path = path_of(key);
+            if (not path or not std::filesystem::exists(*path))
+                return false;
+            if (std::filesystem::file_size(*path) not_eq std::size(values) * sizeof(float))
+                return false; // truncated or foreign file : recomputed, then overwritten
+
+            auto ifs = std::ifstream{ *path, std::ios::binary };
+            if (not ifs.read(reinterpret_cast<char*>(std::data(values)), std::size(values) * sizeof(float)))
+                throw std::runtime_error{"indices::series : cannot read " + path->string()};
+            return true;
+        }
+        void store(const std::tuple<kind, std::size_t, std::size_t> & key, const column_type & values) const {
+            const auto path = path_of(key);
+            if (not path)
+                return;
+            std::filesystem::create_directories(path->parent_path());
+
+            // write then rename : concurrent sweeps never read a partial file
+            auto temporary_path = *path;
+            temporary_path += ".tmp";
+            {
+                auto ofs = std::ofstream{ temporary_path, std::ios::binary | std::ios::trunc };
+                if (not ofs.write(reinterpret_cast<const char*>(std::data(values)), std::size(values) * sizeof(float)))
+                    throw std::runtime_error{"indices::series : cannot write " + temporary_path.string()};
+            }
+            std::filesystem::rename(temporary_path, *path);
+        }
+    };
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <trading_bots/business/data_types.hpp>
+#include <trading_bots/details/io.hpp>
+
+#include <vector>
+#include <span>
+#include <chrono>
+#include <string_view>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+// Date-range seeks over a dataset, in O(log n) :
+//  - chronological : over records already in memory, slices without copying
+//  - sparse        : over a file's content (loaded or io::mapped_file), only the requested lines are then parsed
+//
+// Ranges are inclusive : [from, to], e.g. { sys_days{ 2021y/August/1 }, sys_days{ 2021y/August/31 } }
+
+namespace trading_bots::business::time_index {
+
+    using record_type = trading_bots::business::data_types::record;
+    using timestamp_type = record_type::timestamp_type;
+
+    struct range {
+        timestamp_type from;
+        timestamp_type to;
+
+        bool contains(timestamp_type value) const {
+            return from <= value and value <= to;
+        }
+    };
+
+    // Index of records sorted by Date, oldest first (see backtest::to_chronological).
+    // [records] must outlive this.
+    struct chronological {
+
+        explicit chronological(std::span<const record_type> records)
+        : records{ records }
+        {
+            timestamps.reserve(std::size(records));
+            for (const auto & value : records)
+                timestamps.push_back(value.timestamp());
+            if (not std::is_sorted(std::cbegin(timestamps), std::cend(timestamps)))
+                throw std::invalid_argument{"time_index::chronological : records are not chronological"};
+        }
+
+        // [begin, end) positions of the records in [arg]
+        std::pair<std::size_t, std::size_t> bounds(const range & arg) const {
+            const auto begin = std::lower_bound(std::cbegin(timestamps), std::cend(timestamps), arg.from);
+            const auto end = std::upper_bound(begin, std::cend(timestamps), arg.to);
+            return {
+                static_cast<std::size_t>(std::distance(std::cbegin(timestamps), begin)),
+                static_cast<std::size_t>(std::distance(std::cbegin(timestamps), end))
+            };
+        }
+        std::span<const record_type> slice(const range & arg) const {
+            const auto [begin, end] = bounds(arg);
+            return records.subspan(begin, end - begin);
+        }
+
+    private:
+        std::span<const record_type> records;
+        std::vector<timestamp_type> timestamps;
+    };
+
+    // Index of a CSV file's content (see io::csv::file_header), latest record first.
+    // Only the Date of one line every [block_size] is parsed : seeks then scan at most [block_size] lines.
+    // [content] must outlive this.
+    struct sparse {
+
+        explicit sparse(std::string_view content, std::size_t block_size = 64)
+        : block_size{ std::max(block_size, std::size_t{ 1 }) }
+        {
+            const auto header = content.substr(0, content.find('\n'));
+            if (header.empty())
+                throw std::runtime_error{"empty file"};
+            else if (header not_eq details::io::csv::file_header)
+                throw std::runtime_error{"bad header"};
+            content.remove_prefix(std::min(std::size(header) + 1, std::size(content)));
+            lines_content = content;
+
+            std::size_t line_index = 0;
+            for (std::size_t offset = 0; offset < std::size(content); ++line_index) {
+                if (line_index % this->block_size == 0) {
+                    const auto timestamp = timestamp_at(offset);
+                    if (not std::empty(blocks) and blocks.back().timestamp < timestamp)
+                        throw std::invalid_argument{"time_index::sparse : records are not sorted, latest first"};
+                    blocks.push_back({ timestamp, offset });
+                }
+                offset = next_line(offset);
+            }
+        }
+
+        // lines of the records in [arg], latest first, as in the file
+        std::string_view lines(const range & arg) const {
+            const auto begin = first_line([&](timestamp_type value){ return value <= arg.to; });
+            const auto end = first_line([&](timestamp_type value){ return value < arg.from; });
+            return lines_content.substr(begin, std::max(begin, end) - begin);
+        }
+        // top is the oldest, as io::csv::extract_datas
+        auto extract_datas(const range & arg, std::size_t chunks_count = std::thread::hardware_concurrency()) const {
+            return details::io::csv::extract_lines<record_type>(lines(arg), chunks_count);
+        }
+
+    private:
+        struct block {
+            timestamp_type timestamp;
+            std::size_t offset;
+        };
+        std::size_t block_size;
+        std::string_view lines_content;
+        std::vector<block> blocks;
+
+        std::size_t next_line(std::size_t offset) const {
+            const auto newline_pos = lines_content.find('\n', offset);
+            return newline_pos == std::string_view::npos ? std::size(lines_content) : newline_pos + 1;
+        }
+        timestamp_type timestamp_at(std::size_t offset) const {
+            const auto line = lines_content.substr(offset, next_line(offset) - offset);
+            return record_type::parse_date(line.substr(0, line.find(',')));
+        }
+
+        // offset of the first line (latest first) which timestamp [is_reached], or the end.
+        // [is_reached] must be monotonic over the lines, as timestamps are.
+        std::size_t first_line(auto && is_reached) const {
+            const auto block_it = std::partition_point(std::cbegin(blocks), std::cend(blocks), [&](const block & value){
+                return not is_reached(value.timestamp);
+            });
+            if (block_it == std::cbegin(blocks))
+                return 0;
+
+            // within the previous block
+            auto offset = std::prev(block_it)->offset;
+            const auto end = (block_it == std::cend(blocks)) ? std::size(lines_content) : block_it->offset;
+            while (offset < end and not is_reached(timestamp_at(offset)))
+                offset = next_line(offset);
+            return offset;
+        }
+    };
+}
@@ -0,0 +1,403 @@
+#pragma once
+
+#include <trading_bots/details/io.hpp>
+
+#include <vector>
+#include <deque>
+#include <stack>
+#include <optional>
+#include <iterator>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
+#include <system_error>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+// Linux only
+//
+// Loads many datasets at once : files are read asynchronously (io_uring, reads of many files in flight),
+// while the already-read ones are parsed by a pool of threads.
+// Each dataset is handed to a callback as soon as it is parsed, so a scheduler can start on it.
+//
+// When io_uring is not available (old kernel, seccomp-restricted container, ...),
+// falls back to a pool of threads, each reading then parsing one file at a time.
+
+namespace trading_bots::details::io::uring {
+
+    // Minimal io_uring instance (raw syscalls, no liburing), only for reads.
+    // Not thread-safe.
+    struct ring {
+
+        explicit ring(unsigned entries) {
+            auto params = ::io_uring_params{};
+            fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+            if (fd < 0)
+                throw std::system_error{ errno, std::system_category(), "io::uring::ring : io_uring_setup" };
+
+            sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_size = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+            if (params.features & IORING_FEAT_SINGLE_MMAP)
+                sq_size = cq_size = std::max(sq_size, cq_size);
+            sqes_size = params.sq_entries * sizeof(::io_uring_sqe);
+
+            sq_pointer = ::mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            cq_pointer = (params.features & IORING_FEAT_SINGLE_MMAP)
+                ? sq_pointer
+                : ::mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING)
+            ;
+            sqes = static_cast<::io_uring_sqe *>(::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+            if (sq_pointer == MAP_FAILED or cq_pointer == MAP_FAILED or sqes == MAP_FAILED) {
+                const auto error = errno;
+                release();
+                throw std::system_error{ error, std::system_category(), "io::uring::ring : mmap" };
+            }
+
+            const auto sq_bytes = static_cast<std::byte *>(sq_pointer);
+            sq_head = reinterpret_cast<unsigned *>(sq_bytes + params.sq_off.head);
+            sq_tail = reinterpret_cast<unsigned *>(sq_bytes + params.sq_off.tail);
+            sq_mask = *reinterpret_cast<unsigned *>(sq_bytes + params.sq_off.ring_mask);
+            sq_entries = params.sq_entries;
+            sq_array = reinterpret_cast<unsigned *>(sq_bytes + params.sq_off.array);
+
+            const auto cq_bytes = static_cast<std::byte *>(cq_pointer);
+            cq_head = reinterpret_cast<unsigned *>(cq_bytes + params.cq_off.head);
+            cq_tail = reinterpret_cast<unsigned *>(cq_bytes + params.cq_off.tail);
+            cq_mask = *reinterpret_cast<unsigned *>(cq_bytes + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<::io_uring_cqe *>(cq_bytes + params.cq_off.cqes);
+        }
+        ring(const ring &) = delete;
+        ring & operator=(const ring &) = delete;
+        ~ring() {
+            release();
+        }
+
+        static bool is_available() {
+            try {
+                ring{ 1 };
+                return true;
+            }
+            catch (const std::system_error &) {
+                return false;
+            }
+        }
+
+        // false if the submission queue is full
+        bool prepare_read(int file_descriptor, void * buffer, std::uint32_t size, std::uint64_t offset, std::uint64_t user_data) {
+            const auto tail = *sq_tail;
+            if (tail - std::atomic_ref{ *sq_head }.load(std::memory_order_acquire) == sq_entries)
+                return false;
+            const auto index = tail & sq_mask;
+            auto & sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READ;
+            sqe.fd = file_descriptor;
+            sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+            sqe.len = size;
+            sqe.off = offset;
+            sqe.user_data = user_data;
+            sq_array[index] = index;
+            std::atomic_ref{ *sq_tail }.store(tail + 1, std::memory_order_release);
+            ++to_submit;
+            return true;
+        }
+        // submits prepared reads, and waits for at least [min_completions]
+        void submit_and_wait(unsigned min_completions) {
+            while (true) {
+                const auto result = ::syscall(__NR_io_uring_enter, fd, to_submit, min_completions, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (result >= 0) {
+                    to_submit -= static_cast<unsigned>(result);
+                    return;
+                }
+                if (errno not_eq EINTR)
+                    throw std::system_error{ errno, std::system_category(), "io::uring::ring : io_uring_enter" };
+            }
+        }
+        // on_completion : void(std::uint64_t user_data, std::int32_t result)
+        void for_each_completion(auto && on_completion) {
+            const auto tail = std::atomic_ref{ *cq_tail }.load(std::memory_order_acquire);
+            for (auto head = *cq_head; head not_eq tail; ++head) {
+                const auto cqe = cqes[head & cq_mask];
+                std::atomic_ref{ *cq_head }.store(head + 1, std::memory_order_release); // consumed, even if on_completion throws
+                on_completion(cqe.user_data, cqe.res);
+            }
+        }
+
+    private:
+        int fd = -1;
+        std::size_t sq_size = 0, cq_size = 0, sqes_size = 0;
+        void * sq_pointer = MAP_FAILED;
+        void * cq_pointer = MAP_FAILED;
+        ::io_uring_sqe * sqes = static_cast<::io_uring_sqe *>(MAP_FAILED);
+
+        unsigned * sq_head, * sq_tail, * sq_array;
+        unsigned sq_mask, sq_entries;
+        unsigned * cq_head, * cq_tail;
+        unsigned cq_mask;
+        ::io_uring_cqe * cqes;
+        unsigned to_submit = 0;
+
+        void release() {
+            if (sqes not_eq MAP_FAILED)
+                ::munmap(sqes, sqes_size);
+            if (cq_pointer not_eq MAP_FAILED and cq_pointer not_eq sq_pointer)
+                ::munmap(cq_pointer, cq_size);
+            if (sq_pointer not_eq MAP_FAILED)
+                ::munmap(sq_pointer, sq_size);
+            if (fd not_eq -1)
+                ::close(fd);
+        }
+    };
+}
+
+namespace trading_bots::details::io::batch {
+
+    struct settings {
+        std::size_t threads = std::thread::hardware_concurrency(); // parsing (and, without io_uring, reading)
+        unsigned reads_in_flight = 32;      // io_uring queue depth
+        std::size_t max_pending = 64;       // read, but not parsed yet, datasets (bounds memory)
+        bool use_io_uring = true;
+    };
+
+    // Reads a whole file, blocking. Fallback for batch::load.
+    inline std::string read_file(const std::string & path) {
+        std::ifstream ifs{ path, std::ios::binary | std::ios::ate };
+        if (not ifs.is_open())
+            throw std::invalid_argument{"io::batch::read_file : cannot open " + path};
+        std::string value(static_cast<std::size_t>(ifs.tellg()), '\0');
+        ifs.seekg(0);
+        if (not ifs.read(std::data(value), std::size(value)))
+            throw std::runtime_error{"io::batch::read_file : cannot read " + path};
+        return value;
+    }
+
+    // Loads and parses [paths], concurrently.
+    // on_loaded : void(std::size_t path_index, std::stack<record_type> && records), see io::csv::extract_datas.
+    //  called as soon as each dataset is parsed (so, in any order), from the loader's threads,
+    //  but never concurrently : it does not need to be thread-safe.
+    // The first error (I/O, parsing, or thrown by on_loaded) stops the loading, and is rethrown.
+    template <concepts::io_record_type record_type>
+    void load(const std::vector<std::string> & paths, auto && on_loaded, settings arg = {}) {
+
+        arg.threads = std::clamp(arg.threads, std::size_t{ 1 }, std::max(std::size(paths), std::size_t{ 1 }));
+        arg.reads_in_flight = std::max(arg.reads_in_flight, 1u);
+        arg.max_pending = std::max(arg.max_pending, std::size_t{ 1 });
+
+        std::mutex on_loaded_mutex;
+        const auto parse = [&](std::size_t path_index, const std::string & content) {
+            // datasets are parsed concurrently already : in this thread
+            auto lines = csv::make_records<record_type>(csv::remove_header(content));
+            auto records = std::stack<record_type>{ std::deque<record_type>(
+                std::make_move_iterator(std::begin(lines)),
+                std::make_move_iterator(std::end(lines))
+            )};
+            auto lock = std::scoped_lock{ on_loaded_mutex };
+            on_loaded(path_index, std::move(records));
+        };
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        std::atomic<bool> has_failed = false;
+        const auto on_error = [&]() {
+            has_failed = true;
+            auto lock = std::scoped_lock{ error_mutex };
+            if (not error)
+                error = std::current_exception();
+        };
+
+        // created up-front : its setup may fail even when io_uring is available (e.g. RLIMIT_MEMLOCK, for [reads_in_flight] entries)
+        auto io_ring = std::optional<uring::ring>{};
+        if (arg.use_io_uring)
+            try {
+                io_ring.emplace(arg.reads_in_flight);
+            }
+            catch (const std::system_error &) {}
+
+        if (not io_ring) {
+            std::atomic<std::size_t> next_path_index = 0;
+            {
+                std::vector<std::jthread> workers;
+                for (std::size_t worker_index = 0; worker_index < arg.threads; ++worker_index)
+                    workers.emplace_back([&](){
+                        try {
+                            for (auto path_index = next_path_index++; path_index < std::size(paths) and not has_failed; path_index = next_path_index++)
+                                parse(path_index, read_file(paths[path_index]));
+                        }
+                        catch (...) {
+                            on_error();
+                        }
+                    });
+            } // join
+            if (error)
+                std::rethrow_exception(error);
+            return;
+        }
+
+        // read datasets, to parse
+        struct dataset_type {
+            std::size_t path_index;
+            std::string content;
+        };
+        std::deque<dataset_type> pending;
+        std::mutex pending_mutex;
+        std::condition_variable_any pending_updated;
+        bool is_reading_done = false;
+
+        std::vector<std::jthread> parsers;
+        for (std::size_t worker_index = 0; worker_index < arg.threads; ++worker_index)
+            parsers.emplace_back([&](std::stop_token stop_token){
+                try {
+                    while (true) {
+                        auto lock = std::unique_lock{ pending_mutex };
+                        if (not pending_updated.wait(lock, stop_token, [&](){ return not pending.empty() or is_reading_done; }))
+                            return; // stop requested
+                        if (pending.empty())
+                            return; // done
+                        auto dataset = std::move(pending.front());
+                        pending.pop_front();
+                        lock.unlock();
+                        pending_updated.notify_all(); // room for the reader
+
+                        if (not has_failed)
+                            parse(dataset.path_index, dataset.content);
+                    }
+                }
+                catch (...) {
+                    on_error();
+                    { auto lock = std::scoped_lock{ pending_mutex }; } // the reader is either waiting, or will see has_failed
+                    pending_updated.notify_all();
+                }
+            });
+
+        // reads, from this thread
+        struct read_type {
+            int fd = -1;
+            std::string content;
+            std::size_t offset = 0;
+        };
+        std::vector<read_type> reads(std::size(paths));
+        const auto close_reads = [&]() {
+            for (auto & value : reads)
+                if (value.fd not_eq -1) {
+                    ::close(value.fd);
+                    value.fd = -1;
+                }
+        };
+
+        try {
+            auto & ring = *io_ring;
+            std::size_t next_path_index = 0;
+            std::size_t reads_in_flight = 0;
+
+            const auto prepare_read = [&](std::size_t path_index) {
+                auto & value = reads[path_index];
+                const auto remaining = std::size(value.content) - value.offset;
+                const auto size = static_cast<std::uint32_t>(std::min<std::size_t>(remaining, 1u << 30));
+                if (not ring.prepare_read(value.fd, std::data(value.content) + value.offset, size, value.offset, path_index))
+                    throw std::logic_error{"io::batch::load : submission queue is full"};
+                ++reads_in_flight;
+            };
+            const auto push_pending = [&](std::size_t path_index) {
+                auto & value = reads[path_index];
+                ::close(value.fd);
+                value.fd = -1;
+                {
+                    auto lock = std::scoped_lock{ pending_mutex };
+                    pending.push_back({ path_index, std::move(value.content) });
+                }
+                pending_updated.notify_one();
+            };
+
+            // buffers must outlive in-flight reads, even on failure
+            const auto wait_for_reads = [&]() {
+                while (reads_in_flight not_eq 0) {
+                    ring.submit_and_wait(1);
+                    ring.for_each_completion([&](std::uint64_t, std::int32_t){ --reads_in_flight; });
+                }
+            };
+
+            try {
+                while ((next_path_index < std::size(paths) or reads_in_flight not_eq 0) and not has_failed) {
+
+                    // open and submit new files, as long as there is room
+                    while (next_path_index < std::size(paths) and reads_in_flight < arg.reads_in_flight) {
+                        {
+                            auto lock = std::unique_lock{ pending_mutex };
+                            if (reads_in_flight not_eq 0 and std::size(pending) + reads_in_flight >= arg.max_pending)
+                                break; // completions first
+                            pending_updated.wait(lock, [&](){ return std::size(pending) < arg.max_pending or has_failed; });
+                        }
+                        if (has_failed)
+                            break;
+
+                        const auto path_index = next_path_index++;
+                        auto & value = reads[path_index];
+                        value.fd = ::open(paths[path_index].c_str(), O_RDONLY | O_CLOEXEC);
+                        if (value.fd == -1)
+                            throw std::invalid_argument{"io::batch::load : cannot open " + paths[path_index]};
+                        struct ::stat status;
+                        if (::fstat(value.fd, &status) == -1)
+                            throw std::runtime_error{"io::batch::load : cannot stat " + paths[path_index]};
+                        value.content.resize(static_cast<std::size_t>(status.st_size));
+                        if (value.content.empty())
+                            push_pending(path_index); // then, "empty file"
+                        else prepare_read(path_index);
+                    }
+                    if (reads_in_flight == 0)
+                        continue;
+
+                    ring.submit_and_wait(1);
+                    ring.for_each_completion([&](std::uint64_t user_data, std::int32_t result){
+                        --reads_in_flight;
+                        const auto path_index = static_cast<std::size_t>(user_data);
+                        auto & value = reads[path_index];
+                        if (result < 0) {
+                            // e.g. IORING_OP_READ unsupported (kernel < 5.6) : blocking read instead
+                            const auto read_result = ::pread(value.fd, std::data(value.content) + value.offset, std::size(value.content) - value.offset, static_cast<::off_t>(value.offset));
+                            if (read_result < 0)
+                                throw std::system_error{ errno, std::system_category(), "io::batch::load : cannot read " + paths[path_index] };
+                            result = static_cast<std::int32_t>(read_result);
+                        }
+                        value.offset += static_cast<std::size_t>(result);
+                        if (result == 0) // truncated since fstat
+                            value.content.resize(value.offset);
+                        if (value.offset == std::size(value.content))
+                            push_pending(path_index);
+                        else prepare_read(path_index); // short read
+                    });
+                }
+            }
+            catch (...) {
+                on_error();
+            }
+            wait_for_reads();
+        }
+        catch (...) {
+            on_error();
+        }
+        close_reads();
+
+        {
+            auto lock = std::scoped_lock{ pending_mutex };
+            is_reading_done = true;
+        }
+        pending_updated.notify_all();
+        for (auto & parser : parsers)
+            parser.join();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
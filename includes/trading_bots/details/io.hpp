@@ -5,7 +5,16 @@
 
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <optional>
+#include <charconv>
 #include <stack>
+#include <deque>
+#include <vector>
+#include <future>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
 #include <coroutine>
 
 #ifndef fwd
@@ -20,8 +29,7 @@ namespace trading_bots::details::io::concepts {
             .Low = std::declval<float>(),
             .High = std::declval<float>(),
             .Open = std::declval<float>(),
-            //, Volume(std::stoi(csv::extract_last_field(fwd(line))))
-            .Volume = std::declval<std::string>(),
+            .Volume = std::declval<std::optional<double>>(),
             .CloseLast = std::declval<float>(),
             .Date = std::declval<std::string>(),
         };
@@ -29,6 +37,8 @@ namespace trading_bots::details::io::concepts {
 }
 
 namespace trading_bots::details::io::csv {
+    constexpr std::string_view file_header = "Date,Close/Last,Volume,Open,High,Low";
+
     auto extract_last_field(std::string && line) {
         if (auto pos = line.rfind(','); pos not_eq std::string::npos) {
             auto value = line.substr(pos + 1);
@@ -42,6 +52,17 @@ namespace trading_bots::details::io::csv {
             throw std::invalid_argument{"incomplete input"};
     }
     
+    // "N/A" (or empty) : not available
+    inline std::optional<double> parse_volume(std::string_view field) {
+        if (field.empty() or field == "N/A")
+            return std::nullopt;
+        double value = 0;
+        const auto [end, error] = std::from_chars(std::data(field), std::data(field) + std::size(field), value);
+        if (error not_eq std::errc{} or end not_eq std::data(field) + std::size(field) or value < 0)
+            throw std::invalid_argument{"trading_bots::details::io::csv : corrupted Volume"};
+        return value;
+    }
+
     namespace concepts = trading_bots::details::io::concepts;
     template <concepts::io_record_type record_type>
     auto make_record(std::string && line) {
@@ -50,8 +71,7 @@ namespace trading_bots::details::io::csv {
             .Low = std::stof(csv::extract_last_field(fwd(line))),
             .High = std::stof(csv::extract_last_field(fwd(line))),
             .Open = std::stof(csv::extract_last_field(fwd(line))),
-            //, Volume(std::stoi(csv::extract_last_field(fwd(line))))
-            .Volume = csv::extract_last_field(fwd(line)),
+            .Volume = csv::parse_volume(csv::extract_last_field(fwd(line))),
             .CloseLast = std::stof(csv::extract_last_field(fwd(line))),
             .Date = csv::extract_last_field(fwd(line))
         };
@@ -87,9 +107,6 @@ namespace trading_bots::details::io::csv {
         std::ifstream ifs;
 
         static auto generate_ifstream(const std::string & path) {
-            using namespace std::literals;
-            constexpr auto file_header = "Date,Close/Last,Volume,Open,High,Low"sv;
-
             std::ifstream ifs{ path };
             if (std::string line_buffer; not std::getline(ifs, line_buffer)) {
                 throw std::runtime_error{"empty file"};
@@ -111,4 +128,114 @@ namespace trading_bots::details::io::csv {
     };
 }
 
+namespace trading_bots::details::io::csv {
+
+    // Splits [input] into (at most) [chunks_count] ranges of complete lines,
+    // so each chunk can be parsed independently.
+    inline auto split_lines(std::string_view input, std::size_t chunks_count) {
+
+        chunks_count = std::max(chunks_count, std::size_t{ 1 });
+        const auto chunk_size = std::max(input.size() / chunks_count, std::size_t{ 1 });
+
+        std::vector<std::string_view> chunks;
+        chunks.reserve(chunks_count);
+        while (not input.empty()) {
+            auto end = std::min(chunk_size, input.size());
+            if (end not_eq input.size()) {
+                const auto newline_pos = input.find('\n', end - 1);
+                end = (newline_pos == std::string_view::npos) ? input.size() : newline_pos + 1;
+            }
+            chunks.push_back(input.substr(0, end));
+            input.remove_prefix(end);
+        }
+        return chunks;
+    }
+
+    // Parses each line of [input] (no header), in order.
+    // A trailing newline does not produce an empty record, as with std::getline.
+    template <concepts::io_record_type record_type>
+    auto make_records(std::string_view input) {
+
+        std::vector<record_type> records;
+        records.reserve(std::count(std::cbegin(input), std::cend(input), '\n') + 1);
+        while (not input.empty()) {
+            const auto newline_pos = input.find('\n');
+            const auto line = input.substr(0, newline_pos);
+            records.push_back(csv::make_record<record_type>(std::string{ line }));
+            input.remove_prefix(newline_pos == std::string_view::npos ? input.size() : newline_pos + 1);
+        }
+        return records;
+    }
+
+    // Parses complete lines (no header, e.g. a slice of a file's content),
+    // by chunks of lines parsed concurrently, then stitched back in order : top is the last line.
+    template <concepts::io_record_type record_type>
+    auto extract_lines(std::string_view lines, std::size_t chunks_count = std::thread::hardware_concurrency()) {
+
+        using chunk_type = std::vector<record_type>;
+        std::vector<std::future<chunk_type>> pending_chunks;
+        for (const auto chunk : split_lines(lines, chunks_count))
+            pending_chunks.push_back(std::async(std::launch::async, [chunk](){
+                return make_records<record_type>(chunk);
+            }));
+
+        std::deque<record_type> records;
+        for (auto & pending_chunk : pending_chunks) {
+            auto chunk = pending_chunk.get(); // rethrows parsing/integrity errors
+            std::move(std::begin(chunk), std::end(chunk), std::back_inserter(records));
+        }
+        return std::stack<record_type>{ std::move(records) };
+    }
+
+    // Lines of a file's content, after its (checked) header
+    inline std::string_view remove_header(std::string_view content) {
+        const auto header = content.substr(0, content.find('\n'));
+        if (header.empty())
+            throw std::runtime_error{"empty file"};
+        else if (header not_eq file_header)
+            throw std::runtime_error{"bad header"};
+        content.remove_prefix(std::min(std::size(header) + 1, std::size(content)));
+        return content;
+    }
+
+    // Parses the whole content of a file (header included), already in memory (loaded, mapped, ...).
+    // Same result as csv::file::extract_datas.
+    template <concepts::io_record_type record_type>
+    auto extract_datas(std::string_view content, std::size_t chunks_count = std::thread::hardware_concurrency()) {
+        return extract_lines<record_type>(remove_header(content), chunks_count);
+    }
+
+    // Same as csv::file, but loads the whole file at once, then see csv::extract_datas
+    template <concepts::io_record_type record_type>
+    struct parallel_file {
+
+        parallel_file(const std::string & path, std::size_t chunks_count = std::thread::hardware_concurrency())
+        : content{ load(path) }
+        , chunks_count{ std::max(chunks_count, std::size_t{ 1 }) }
+        {}
+
+        auto extract_datas() {
+            return csv::extract_datas<record_type>(content, chunks_count);
+        }
+
+    private:
+
+        std::string content;
+        std::size_t chunks_count;
+
+        static auto load(const std::string & path) {
+
+            std::ifstream ifs{ path, std::ios::binary | std::ios::ate };
+            if (not ifs.is_open())
+                throw std::invalid_argument{"trading_bots::details::io::csv::parallel_file : cannot open"};
+
+            std::string value(static_cast<std::size_t>(ifs.tellg()), '\0');
+            ifs.seekg(0);
+            if (not ifs.read(std::data(value), std::size(value)))
+                throw std::runtime_error{"trading_bots::details::io::csv::parallel_file : cannot read"};
+            return value;
+        }
+    };
+}
+
 #undef fwd
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// POSIX only
+
+namespace trading_bots::details::io {
+
+    // Read-only, shared mapping of a whole file :
+    // processes mapping the same file (or forked after the mapping) share the same physical pages.
+    struct mapped_file {
+
+        explicit mapped_file(const std::string & path) {
+            const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1)
+                throw std::invalid_argument{"trading_bots::details::io::mapped_file : cannot open " + path};
+
+            struct ::stat status;
+            if (::fstat(fd, &status) == -1) {
+                ::close(fd);
+                throw std::runtime_error{"trading_bots::details::io::mapped_file : cannot stat " + path};
+            }
+            size = static_cast<std::size_t>(status.st_size);
+            if (size not_eq 0) {
+                data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+                if (data == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error{"trading_bots::details::io::mapped_file : cannot map " + path};
+                }
+            }
+            ::close(fd); // the mapping stays valid
+        }
+        mapped_file(const mapped_file &) = delete;
+        mapped_file & operator=(const mapped_file &) = delete;
+        mapped_file(mapped_file && other) noexcept
+        : data{ std::exchange(other.data, nullptr) }
+        , size{ std::exchange(other.size, 0) }
+        {}
+        mapped_file & operator=(mapped_file && other) noexcept {
+            std::swap(data, other.data);
+            std::swap(size, other.size);
+            return *this;
+        }
+        ~mapped_file() {
+            if (data)
+                ::munmap(data, size);
+        }
+
+        std::string_view content() const {
+            return { static_cast<const char *>(data), size };
+        }
+
+    private:
+        void * data = nullptr;
+        std::size_t size = 0;
+    };
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+#include <optional>
+
+namespace trading_bots::details::memory {
+
+    // Forwards to [upstream], counting calls
+    struct counting_resource : std::pmr::memory_resource {
+
+        explicit counting_resource(std::pmr::memory_resource * upstream = std::pmr::new_delete_resource())
+        : upstream{ upstream }
+        {}
+
+        std::size_t allocations = 0;
+        std::size_t deallocations = 0;
+        std::size_t allocated_bytes = 0;
+
+        void reset_counters() {
+            allocations = deallocations = allocated_bytes = 0;
+        }
+
+    private:
+        std::pmr::memory_resource * upstream;
+
+        void * do_allocate(std::size_t bytes, std::size_t alignment) override {
+            ++allocations;
+            allocated_bytes += bytes;
+            return upstream->allocate(bytes, alignment);
+        }
+        void do_deallocate(void * pointer, std::size_t bytes, std::size_t alignment) override {
+            ++deallocations;
+            upstream->deallocate(pointer, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // Storage for per-run states (features caches, per-run containers, ...), released in one operation by reset.
+    // Not thread-safe : one arena per thread, so threads never contend on the global allocator.
+    //
+    // Memory freed during a run is reused by that run (pool), and never returned to the global allocator before reset.
+    // On reset, the arena grows to what the previous run needed : same-sized runs then allocate nothing upstream.
+    struct arena {
+
+        explicit arena(std::size_t initial_size = 64 * 1024)
+        : capacity{ initial_size }
+        {
+            rebuild();
+        }
+        arena(const arena &) = delete;
+        arena & operator=(const arena &) = delete;
+
+        std::pmr::polymorphic_allocator<> allocator() {
+            return std::pmr::polymorphic_allocator<>{ &*pool };
+        }
+        std::pmr::memory_resource * resource() {
+            return &*pool;
+        }
+
+        // Invalidates everything allocated since the last reset
+        void reset() {
+            const auto previous_run_bytes = buffer_usage.allocated_bytes;
+            if (previous_run_bytes not_eq 0) { // has overflowed the buffer
+                capacity += previous_run_bytes;
+                ++buffer_growths;
+            }
+            rebuild();
+        }
+
+        // global allocator calls since construction
+        std::size_t upstream_allocations() const {
+            return upstream.allocations;
+        }
+        std::size_t growths() const {
+            return buffer_growths;
+        }
+
+    private:
+        counting_resource upstream; // global allocator
+        std::size_t capacity;
+        std::size_t buffer_growths = 0;
+        std::pmr::vector<std::byte> buffer{ &upstream };
+        counting_resource buffer_usage{ &upstream }; // overflow of [buffer], for this run
+        std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+        std::optional<std::pmr::unsynchronized_pool_resource> pool;
+
+        void rebuild() {
+            pool.reset();
+            monotonic.reset();
+            if (std::size(buffer) < capacity) {
+                buffer = std::pmr::vector<std::byte>{ &upstream };
+                buffer.resize(capacity);
+            }
+            buffer_usage.reset_counters();
+            monotonic.emplace(std::data(buffer), std::size(buffer), &buffer_usage);
+            pool.emplace(&*monotonic);
+        }
+    };
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <trading_bots/details/io.hpp>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+#include <optional>
+#include <queue>
+
+// Merges overlapping CSV exports (see io::csv::file_header), latest record first, into one dataset :
+//  - one pass : each input is read once, line by line, so memory is bounded by the number of inputs
+//  - records of the same Date are deduplicated, according to a conflict_policy
+//  - the output is in the same format (latest first), so it can be read as any export
+
+namespace trading_bots::details::io::csv::merge {
+
+    enum class conflict_policy {
+        keep_first,     // record of the first input (in the inputs order)
+        keep_last,      // record of the last input  (in the inputs order)
+        average,        // average of prices, and of the available volumes
+        reject          // throws if values differ
+    };
+
+    struct summary {
+        std::size_t records_read = 0;
+        std::size_t records_written = 0;
+        std::size_t duplicates = 0;     // records dropped, as another one has the same Date
+        std::size_t conflicts = 0;      // dates which records have different values
+    };
+
+    namespace concepts {
+        template <typename T>
+        concept mergeable_record_type =
+            io::concepts::io_record_type<T> and
+            requires (const T & value) { value.timestamp(); }
+        ;
+    }
+
+    // Streams [paths] merged records (latest first) to [sink] : void(const record_type &)
+    template <concepts::mergeable_record_type record_type>
+    summary run(const std::vector<std::string> & paths, conflict_policy policy, auto && sink) {
+
+        using timestamp_type = decltype(std::declval<const record_type &>().timestamp());
+
+        struct input_type {
+            std::ifstream ifs;
+            std::string path;
+            std::optional<record_type> value;
+            timestamp_type timestamp;
+        };
+        std::vector<input_type> inputs;
+        inputs.reserve(std::size(paths));
+
+        summary result;
+        const auto next = [&](input_type & input) {
+            std::string line;
+            if (not std::getline(input.ifs, line)) {
+                input.value.reset();
+                return false;
+            }
+            if (line.empty()) { // only trailing empty lines end the input
+                while (std::getline(input.ifs, line))
+                    if (not line.empty())
+                        throw std::runtime_error{"io::csv::merge : empty line before the end of " + input.path};
+                input.value.reset();
+                return false;
+            }
+            auto value = csv::make_record<record_type>(std::move(line));
+            const auto timestamp = value.timestamp();
+            if (input.value and input.timestamp < timestamp)
+                throw std::runtime_error{"io::csv::merge : records are not sorted, latest first, in " + input.path};
+            input.value = std::move(value);
+            input.timestamp = timestamp;
+            ++result.records_read;
+            return true;
+        };
+
+        // latest timestamp first, then inputs order
+        const auto compare = [&inputs](std::size_t lhs, std::size_t rhs) {
+            if (inputs[lhs].timestamp not_eq inputs[rhs].timestamp)
+                return inputs[lhs].timestamp < inputs[rhs].timestamp;
+            return lhs > rhs;
+        };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(compare)> pending{ compare };
+
+        for (const auto & path : paths) {
+            auto & input = inputs.emplace_back(input_type{ std::ifstream{ path }, path, std::nullopt, {} });
+            if (not input.ifs.is_open())
+                throw std::invalid_argument{"io::csv::merge : cannot open " + path};
+            if (std::string header; not std::getline(input.ifs, header))
+                throw std::runtime_error{"empty file"};
+            else if (header not_eq file_header)
+                throw std::runtime_error{"bad header"};
+        }
+        for (std::size_t index = 0; index < std::size(inputs); ++index)
+            if (next(inputs[index]))
+                pending.push(index);
+
+        std::vector<std::size_t> group; // same Date, inputs order
+        while (not pending.empty()) {
+
+            group.clear();
+            const auto timestamp = inputs[pending.top()].timestamp;
+            while (not pending.empty() and inputs[pending.top()].timestamp == timestamp) {
+                group.push_back(pending.top());
+                pending.pop();
+            }
+
+            const auto & first = *inputs[group.front()].value;
+            const auto & last = *inputs[group.back()].value;
+            const bool is_conflict = std::any_of(std::next(std::cbegin(group)), std::cend(group), [&](std::size_t index){
+                const auto & value = *inputs[index].value;
+                return
+                    value.Low not_eq first.Low or value.High not_eq first.High or
+                    value.Open not_eq first.Open or value.CloseLast not_eq first.CloseLast or
+                    value.Volume not_eq first.Volume
+                ;
+            });
+            result.duplicates += std::size(group) - 1;
+            result.conflicts += is_conflict;
+
+            switch (policy) {
+                case conflict_policy::keep_first:
+                    sink(first);
+                    break;
+                case conflict_policy::keep_last:
+                    sink(last);
+                    break;
+                case conflict_policy::average: {
+                    if (not is_conflict) {
+                        sink(first);
+                        break;
+                    }
+                    double low = 0, high = 0, open = 0, close = 0, volume = 0;
+                    std::size_t volumes_quantity = 0;
+                    for (const auto index : group) {
+                        const auto & value = *inputs[index].value;
+                        low += value.Low;
+                        high += value.High;
+                        open += value.Open;
+                        close += value.CloseLast;
+                        if (value.Volume) {
+                            volume += *value.Volume;
+                            ++volumes_quantity;
+                        }
+                    }
+                    const auto quantity = static_cast<double>(std::size(group));
+                    auto value = first;
+                    value.Low = static_cast<float>(low / quantity);
+                    value.High = static_cast<float>(high / quantity);
+                    value.Open = static_cast<float>(open / quantity);
+                    value.CloseLast = static_cast<float>(close / quantity);
+                    if (volumes_quantity not_eq 0)
+                        value.Volume = volume / static_cast<double>(volumes_quantity);
+                    sink(value);
+                    break;
+                }
+                case conflict_policy::reject:
+                    if (is_conflict)
+                        throw std::runtime_error{"io::csv::merge : conflicting records for Date " + first.Date};
+                    sink(first);
+                    break;
+            }
+            ++result.records_written;
+
+            // duplicates within a single input : the first one is kept
+            for (const auto index : group) {
+                bool has_next = next(inputs[index]);
+                for (; has_next and inputs[index].timestamp == timestamp; has_next = next(inputs[index]))
+                    ++result.duplicates;
+                if (has_next)
+                    pending.push(index);
+            }
+        }
+        return result;
+    }
+
+    // One line of a CSV export (see io::csv::file_header).
+    // Prices and volumes are written as the shortest text that reads back as the same value.
+    template <io::concepts::io_record_type record_type>
+    void write(std::ostream & os, const record_type & value) {
+
+        char buffer[32];
+        const auto write_number = [&](auto field) {
+            const auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), field);
+            os.write(buffer, end - buffer);
+        };
+        os << value.Date << ',';
+        write_number(value.CloseLast);
+        os << ',';
+        if (value.Volume)
+            write_number(*value.Volume);
+        else os << "N/A";
+        os << ',';
+        write_number(value.Open);
+        os << ',';
+        write_number(value.High);
+        os << ',';
+        write_number(value.Low);
+        os << '\n';
+    }
+
+    // Merges [paths] into a new export, at [output_path]
+    template <concepts::mergeable_record_type record_type>
+    summary to_file(const std::vector<std::string> & paths, const std::string & output_path, conflict_policy policy) {
+
+        auto ofs = std::ofstream{ output_path, std::ios::trunc };
+        if (not ofs.is_open())
+            throw std::invalid_argument{"io::csv::merge : cannot open " + output_path};
+        ofs << file_header << '\n';
+
+        const auto result = merge::run<record_type>(paths, policy, [&ofs](const record_type & value){
+            merge::write(ofs, value);
+        });
+        if (not ofs.flush())
+            throw std::runtime_error{"io::csv::merge : cannot write " + output_path};
+        return result;
+    }
+}
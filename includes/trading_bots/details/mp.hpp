@@ -1,6 +1,8 @@
 #pragma once
 
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace trading_bots::details::mp {
     // todo : universal template parameter, to merge ttps/nttps
@@ -60,4 +62,37 @@ namespace trading_bots::details {
 
     template <typename T>
     concept StorageType = TupleType<T> and mp::has_unique_ttps_v<T>;
-}
\ No newline at end of file
+}
+
+namespace trading_bots::details::mp {
+
+    // std::tuple of the types of [tuples_ts...] (std::tuples), each once, in order of first appearance
+    template <typename result_type, typename ... Ts>
+    struct unique_append {
+        using type = result_type;
+    };
+    template <typename ... result_ts, typename first, typename ... rest>
+    struct unique_append<std::tuple<result_ts...>, first, rest...> {
+        using type = typename unique_append<
+            std::conditional_t<
+                (std::is_same_v<first, result_ts> or ...),
+                std::tuple<result_ts...>,
+                std::tuple<result_ts..., first>
+            >,
+            rest...
+        >::type;
+    };
+    template <typename ... tuples_ts>
+    struct tuple_union {
+        using type = decltype([]<typename ... Ts>(std::type_identity<std::tuple<Ts...>>){
+            return std::type_identity<typename unique_append<std::tuple<>, Ts...>::type>{};
+        }(std::type_identity<decltype(std::tuple_cat(std::declval<tuples_ts>()...))>{}))::type;
+    };
+    template <typename ... tuples_ts>
+    using tuple_union_t = typename tuple_union<tuples_ts...>::type;
+
+    static_assert(std::is_same_v<
+        tuple_union_t<std::tuple<int, char>, std::tuple<>, std::tuple<char, float, int>>,
+        std::tuple<int, char, float>
+    >);
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <optional>
+#include <thread>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+
+// Linux/POSIX only
+//
+// Sweeps over a parameter space [0, configurations_quantity), sharded across local worker processes :
+//  - workers are forked, so they share the parent's read-only mappings (e.g. io::mapped_file datasets)
+//  - a worker crash only loses its current shard, which is re-assigned, and the worker is replaced
+//  - shards are pulled by workers as they finish, so early finishers take over the remaining work
+//
+// Workers and coordinator only talk through a stream socket, using sharding::protocol :
+//  a remote coordinator only needs to serve the same messages over TCP to sharding::work.
+
+namespace trading_bots::details::sharding::protocol {
+
+    struct assignment {         // coordinator -> worker
+        std::uint64_t begin;
+        std::uint64_t end;      // begin == end : stop
+    };
+    struct report {             // worker -> coordinator, followed by (end - begin) scores (double)
+        std::uint64_t begin;
+        std::uint64_t end;      // begin == end : ready, no scores
+    };
+
+    // false if the peer is gone
+    inline bool send_all(int fd, const void * data, std::size_t size) {
+        auto bytes = static_cast<const std::byte *>(data);
+        while (size not_eq 0) {
+            const auto sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+            if (sent == -1 and errno == EINTR)
+                continue;
+            if (sent <= 0)
+                return false;
+            bytes += sent;
+            size -= static_cast<std::size_t>(sent);
+        }
+        return true;
+    }
+    // false if the peer is gone
+    inline bool receive_all(int fd, void * data, std::size_t size) {
+        auto bytes = static_cast<std::byte *>(data);
+        while (size not_eq 0) {
+            const auto received = ::recv(fd, bytes, size, 0);
+            if (received == -1 and errno == EINTR)
+                continue;
+            if (received <= 0)
+                return false;
+            bytes += received;
+            size -= static_cast<std::size_t>(received);
+        }
+        return true;
+    }
+}
+
+namespace trading_bots::details::sharding {
+
+    // Worker side : pulls shards from the coordinator connected to [fd], until stopped or disconnected.
+    // evaluate : configuration_index -> score (double)
+    void work(int fd, auto && evaluate) {
+
+        constexpr auto ready = protocol::report{ 0, 0 };
+        if (not protocol::send_all(fd, &ready, sizeof(ready)))
+            return;
+
+        std::vector<double> scores;
+        for (protocol::assignment shard; protocol::receive_all(fd, &shard, sizeof(shard));) {
+            if (shard.begin == shard.end)
+                return;
+            scores.clear();
+            for (auto index = shard.begin; index not_eq shard.end; ++index)
+                scores.push_back(static_cast<double>(evaluate(static_cast<std::size_t>(index))));
+
+            const auto report = protocol::report{ shard.begin, shard.end };
+            if (not protocol::send_all(fd, &report, sizeof(report)) or
+                not protocol::send_all(fd, std::data(scores), std::size(scores) * sizeof(double)))
+                return;
+        }
+    }
+
+    struct settings {
+        std::size_t workers = std::thread::hardware_concurrency();
+        std::size_t shard_size = 16;    // configurations per assignment
+        std::size_t max_attempts = 2;   // per shard, as a shard crashing all its workers is likely deterministic
+    };
+
+    // Coordinator : forks [settings.workers] processes, each calling make_evaluator() once,
+    // then evaluating the shards it is assigned. Returns the score of each configuration.
+    //
+    // Note : forks the calling process. Avoid calling it while other threads hold locks.
+    std::vector<double> run(std::size_t configurations_quantity, auto && make_evaluator, settings arg = {}) {
+
+        arg.workers = std::max(arg.workers, std::size_t{ 1 });
+        arg.shard_size = std::max(arg.shard_size, std::size_t{ 1 });
+
+        struct shard_type {
+            std::uint64_t begin, end;
+            std::size_t attempts = 0;
+        };
+        std::deque<shard_type> pending_shards;
+        for (std::size_t begin = 0; begin < configurations_quantity; begin += arg.shard_size)
+            pending_shards.push_back({ begin, std::min(begin + arg.shard_size, configurations_quantity) });
+        auto remaining_shards = std::size(pending_shards);
+
+        struct worker_type {
+            ::pid_t pid;
+            int fd;
+            bool is_ready = false;              // has reported at least once : make_evaluator succeeded
+            bool is_waiting = false;            // for an assignment
+            std::optional<shard_type> shard;    // in flight
+        };
+        std::vector<worker_type> workers;
+
+        const auto close_worker = [](worker_type & worker) {
+            ::close(worker.fd);
+            worker.fd = -1;
+            int status = 0;
+            while (::waitpid(worker.pid, &status, 0) == -1 and errno == EINTR) {}
+        };
+        const auto stop_all = [&]() {
+            constexpr auto stop = protocol::assignment{ 0, 0 };
+            for (auto & worker : workers)
+                if (worker.fd not_eq -1) {
+                    protocol::send_all(worker.fd, &stop, sizeof(stop));
+                    close_worker(worker);
+                }
+        };
+        const auto spawn_worker = [&]() {
+            std::cout.flush(); // or children would flush it again
+            std::fflush(nullptr);
+            int fds[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1) {
+                stop_all();
+                throw std::runtime_error{"sharding::run : socketpair"};
+            }
+            const auto pid = ::fork();
+            if (pid == -1) {
+                ::close(fds[0]);
+                ::close(fds[1]);
+                stop_all();
+                throw std::runtime_error{"sharding::run : fork"};
+            }
+            if (pid == 0) { // worker
+                ::close(fds[0]);
+                for (const auto & worker : workers)
+                    if (worker.fd not_eq -1)
+                        ::close(worker.fd);
+                int exit_code = 0;
+                try {
+                    work(fds[1], make_evaluator());
+                }
+                catch (const std::exception & error) {
+                    std::cerr << "sharding::run : worker error : " << error.what() << '\n';
+                    exit_code = 1;
+                }
+                catch (...) {
+                    exit_code = 1;
+                }
+                std::cout.flush();
+                std::cerr.flush();
+                ::_exit(exit_code); // never returns into the coordinator's code
+            }
+            ::close(fds[1]);
+            return worker_type{ pid, fds[0], false, false, std::nullopt };
+        };
+        // A failed worker is replaced in place while shards remain, so only max_attempts bounds retries.
+        // Not if it failed before its first report : make_evaluator itself fails, which a new worker would repeat.
+        const auto on_failure = [&](worker_type & worker) {
+            close_worker(worker);
+            if (worker.shard) {
+                if (++(worker.shard->attempts) >= arg.max_attempts) {
+                    stop_all();
+                    throw std::runtime_error{"sharding::run : shard failed too many times"};
+                }
+                pending_shards.push_front(*worker.shard); // redistributed to the next waiting worker
+                worker.shard.reset();
+            }
+            if (worker.is_ready and remaining_shards not_eq 0)
+                worker = spawn_worker();
+        };
+        // idle workers are kept until the end, as in-flight shards may still be redistributed
+        const auto dispatch = [&]() {
+            for (auto & worker : workers) {
+                if (pending_shards.empty())
+                    return;
+                if (worker.fd == -1 or not worker.is_waiting)
+                    continue;
+                worker.is_waiting = false;
+                worker.shard = pending_shards.front();
+                pending_shards.pop_front();
+                const auto assignment = protocol::assignment{ worker.shard->begin, worker.shard->end };
+                if (not protocol::send_all(worker.fd, &assignment, sizeof(assignment)))
+                    on_failure(worker);
+            }
+        };
+
+        const auto workers_quantity = std::min(arg.workers, std::size(pending_shards));
+        workers.reserve(workers_quantity);
+        for (std::size_t index = 0; index < workers_quantity; ++index)
+            workers.push_back(spawn_worker());
+
+        std::vector<double> scores(configurations_quantity, std::nan(""));
+        std::vector<::pollfd> poll_fds;
+        while (remaining_shards not_eq 0) {
+
+            poll_fds.clear();
+            for (const auto & worker : workers)
+                if (worker.fd not_eq -1)
+                    poll_fds.push_back({ worker.fd, POLLIN, 0 });
+            if (poll_fds.empty())
+                throw std::runtime_error{"sharding::run : all workers died"};
+
+            if (::poll(std::data(poll_fds), std::size(poll_fds), -1) == -1) {
+                if (errno == EINTR)
+                    continue;
+                stop_all();
+                throw std::runtime_error{"sharding::run : poll"};
+            }
+
+            for (const auto & poll_fd : poll_fds) {
+                if (poll_fd.revents == 0)
+                    continue;
+                auto & worker = *std::find_if(std::begin(workers), std::end(workers), [&](const auto & value){
+                    return value.fd == poll_fd.fd;
+                });
+
+                auto report = protocol::report{};
+                if (not protocol::receive_all(worker.fd, &report, sizeof(report))) {
+                    on_failure(worker);
+                    continue;
+                }
+                if (report.begin not_eq report.end) {
+                    if (not worker.shard or report.begin not_eq worker.shard->begin or report.end not_eq worker.shard->end) {
+                        stop_all();
+                        throw std::runtime_error{"sharding::run : unexpected report"};
+                    }
+                    if (not protocol::receive_all(worker.fd, std::data(scores) + report.begin, (report.end - report.begin) * sizeof(double))) {
+                        on_failure(worker);
+                        continue;
+                    }
+                    worker.shard.reset();
+                    --remaining_shards;
+                }
+                worker.is_ready = true;
+                worker.is_waiting = true;
+            }
+            dispatch();
+        }
+        stop_all();
+        return scores;
+    }
+}
@@ -1,16 +1,22 @@
 #include <trading_bots/business/automatas.hpp>
 #include <trading_bots/business/indices.hpp>
+#include <trading_bots/business/backtest.hpp>
+#include <trading_bots/business/results.hpp>
+#include <trading_bots/business/time_index.hpp>
 
 #include <trading_bots/details/io.hpp>
+#include <trading_bots/details/mapped_file.hpp>
 #include <trading_bots/details/tuple_view.hpp>
 
 #include <gcl/cx/type_name.hpp>
 
 #include <memory>
+#include <array>
 #include <iostream>
 #include <iomanip>
 #include <queue>
 #include <optional>
+#include <filesystem>
 #include <algorithm>
 #include <numeric>
 #include <variant>
@@ -30,62 +36,81 @@
 
 using namespace std::literals;
 
-template <typename ... Ts>
-auto make_array_of_variants(auto && ... args) {
-    using element_type = std::variant<Ts...>;
-    return std::array<element_type, sizeof...(Ts)>{
-        Ts{ args... }...
-    };
-}
-
 template <typename ... automatas_types>
-void run_for_datas(const std::string & path, const float initial_amount) {
+void run_for_datas(
+    const std::string & path,
+    const float initial_amount,
+    const std::optional<std::filesystem::path> & results_path = std::nullopt,
+    const std::optional<trading_bots::business::time_index::range> & range = std::nullopt // only parses and processes these records
+) {
     using namespace trading_bots;
 
-    auto process_dispatcher = [](auto & features_container, auto & value) constexpr {
-        auto features_requested = [&features_container]<template <typename ...> typename T, typename ... Ts>(T<Ts...>){
-            // todo : better errors when some features are missing (avoid error bloat in std::tuple impl details)
-            return details::tuple_view::make_tuple_view<Ts...>(features_container);
-        }(typename std::remove_cvref_t<decltype(value)>::components_type{});
-        value.process(std::move(features_requested));
-    };
-
     using record_type = business::data_types::record;
-    auto records = details::io::csv::file<record_type>{ path }.extract_datas();
-    auto features = std::tuple {
-        business::indices::last_record{},
-        business::indices::rsi{},
-        business::indices::trend{},
-        business::indices::roc{}
-    };
-    auto automatas = make_array_of_variants<automatas_types...>(initial_amount);
+    const auto records = backtest::to_chronological([&](){
+        if (not range)
+            return details::io::csv::parallel_file<record_type>{ path }.extract_datas();
+        const auto dataset = details::io::mapped_file{ path };
+        return business::time_index::sparse{ dataset.content() }.extract_datas(*range);
+    }());
+    const auto series = backtest::make_series(records);
+    auto features = backtest::features_type{};
+    backtest::use(features, series);
+    auto automatas = backtest::make_array_of_variants<automatas_types...>(initial_amount);
+
+    // equity curves and orders, if requested
+    auto recorders = std::array<results::recorder, sizeof...(automatas_types)>{};
+    if (results_path)
+        for (std::size_t index = 0; index < std::size(automatas); ++index)
+            std::visit([&](auto & value){ recorders[index].attach(value); }, automatas[index]);
 
     // process strategies ...
-    std::size_t records_quantity = records.size();
-    while (not records.empty()) {
-        // record
-        auto latest_record = [&records](){
-            auto value = std::move(records.top());
-            records.pop();
-            return value;
-        }();
+    auto is_bankrupt = std::array<bool, sizeof...(automatas_types)>{};
+    const std::size_t records_quantity = records.size();
+    for (const auto & latest_record : records) {
         // features
-        [&features, &latest_record]<std::size_t ... indexes>(std::index_sequence<indexes...>){
-            ((std::get<indexes>(features).update(latest_record)), ...);
-        }(std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<decltype(features)>>>());
-        // automatas
-        for (auto & element : automatas)
+        backtest::update(features, latest_record);
+        // automatas : bankrupt ones are not processed anymore
+        for (std::size_t index = 0; index < std::size(automatas); ++index)
             std::visit([&](auto & value){
-                value.update(latest_record);
-                process_dispatcher(features, value);
-            }, element);
+                if (is_bankrupt[index])
+                    return;
+                try {
+                    value.update(latest_record);
+                }
+                catch (const automata::bankruptcy_error &) {
+                    is_bankrupt[index] = true;
+                    return;
+                }
+                backtest::process(features, value);
+            }, automatas[index]);
+        // results
+        if (results_path) {
+            const auto timestamp = latest_record.timestamp();
+            for (std::size_t index = 0; index < std::size(automatas); ++index)
+                std::visit([&](const auto & value){
+                    recorders[index].update(timestamp, static_cast<double>(value.total_capital()));
+                }, automatas[index]);
+        }
+    }
+    if (results_path) {
+        auto output = results::writer{ *results_path };
+        for (std::size_t index = 0; index < std::size(automatas); ++index)
+            std::visit([&](const auto & value){
+                output.write(recorders[index].finish(
+                    std::string{ gcl::cx::type_name_v<std::remove_cvref_t<decltype(value)>> },
+                    initial_amount,
+                    static_cast<double>(value.total_capital()),
+                    path
+                ));
+            }, automatas[index]);
+        output.close();
     }
 
     // show results ...
     std::cout << "\n\nProcessed records : " << records_quantity << '\n';
-    for (auto & automata_value : automatas)
+    for (std::size_t index = 0; index < std::size(automatas); ++index)
         std::visit(
-            [initial_amount](auto & value) {
+            [initial_amount, is_bankrupt = is_bankrupt[index]](auto & value) {
                 auto win_or_loss_rate = ((value.total_capital() / initial_amount) * 100) - 100;
                 std::cout
                     << '\t' << std::setw(130) << std::left
@@ -93,9 +118,10 @@ void run_for_datas(const std::string & path, const float initial_amount) {
                     << " : " << std::setw(10) << value.total_capital()
                     << " = " << std::setw(10) << (value.total_capital() - initial_amount)
                     << " | " << (win_or_loss_rate < 0 ? '-' : '+') << ' ' << std::setw(8) << ((value.total_capital() / initial_amount) * 100) - 100 << " %"
+                    << (is_bankrupt ? " (bankrupt)" : "")
                     << '\n'
                 ;
-            }, automata_value
+            }, automatas[index]
         );
 }
 